@@ -0,0 +1,225 @@
+/*******************************************************************
+*   bench.cpp
+*   Sorting Networks
+*
+*	Author: Kareem Omar
+*	kareem.omar@uah.edu
+*	https://github.com/komrad36
+*
+*	Last updated Aug 26, 2026
+*******************************************************************/
+//
+// Benchmark harness for the sorting-network kernels, so the cycle
+// claims in the README can actually be verified on your machine and
+// regressions caught when you bump compilers.
+//
+// Build it straight against the library sources, e.g.:
+//
+//     g++ -O3 -mavx2 bench.cpp sorts.cpp -o bench      (Linux)
+//     cl /O2 /arch:AVX2 bench.cpp sorts.cpp            (Windows)
+//
+// (add -mavx512f -mavx512bw -mavx512vbmi or /arch:AVX512 to exercise
+// the AVX-512 batch paths.)
+//
+// Every kernel is measured in two modes:
+//
+//   throughput - many independent arrays, back to back, the way a
+//                batch workload runs. Reported as cycles per array
+//                and cycles per element.
+//   latency    - each call's input depends on the previous call's
+//                output, exposing the true dependency-chain length
+//                of one sort.
+//
+// and with two input distributions: uniform random and already-sorted
+// (sorted input is the best case for the cmov/shuffle-mask approach
+// and the worst case for branky code, so the gap between the two is a
+// quick misprediction smell test).
+//
+// Timing is __rdtscp-serialized on both edges (rdtscp waits for
+// preceding instructions to retire; the trailing lfence keeps later
+// instructions from starting early). Inputs come from a fixed-seed
+// LCG, so runs are reproducible bit for bit.
+//
+// The assembly kernels (sort2a() ... sort16a(), simdsort4a() etc.)
+// can be measured too if you assemble and link them; build with
+// -DBENCH_ASM_KERNELS in that case. On Windows assemble the MASM
+// .asm files; on Linux just add sorts_sysv.S to the compile line.
+//
+
+#include "sorts.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+#ifdef BENCH_ASM_KERNELS
+extern "C" void sort2a(int* v);
+extern "C" void sort3a(int* v);
+extern "C" void sort4a(int* v);
+extern "C" void sort5a(int* v);
+extern "C" void sort6a(int* v);
+extern "C" void sort8a(int* v);
+extern "C" void sort16a(int* v);
+extern "C" void simdsort4a(int* v);
+extern "C" void simdsort4a_noconstants(int* v);
+extern "C" void simdsort4a_nofloat(int* v);
+#endif
+
+static const size_t ARRAYS = 1 << 16;
+static const int REPS = 25;
+
+static uint32_t lcg_state = 0x12345678U;
+static uint32_t lcg() {
+	lcg_state = lcg_state * 1664525U + 1013904223U;
+	return lcg_state;
+}
+
+static uint64_t tic() {
+	unsigned aux;
+	const uint64_t t = __rdtscp(&aux);
+	_mm_lfence();
+	return t;
+}
+
+// fill 'count' arrays of 'n' elements; sorted distribution pre-sorts
+// each array so the kernels see their best case
+template <typename T>
+static void fill(T* v, size_t n, size_t count, bool sorted) {
+	for (size_t i = 0; i < n * count; ++i)
+		v[i] = static_cast<T>(lcg());
+	if (sorted)
+		for (size_t i = 0; i < count; ++i)
+			std::sort(v + n * i, v + n * i + n);
+}
+
+template <typename T, typename F>
+static void bench(const char* name, size_t n, F f) {
+	static T buf[32 * ARRAYS];	// big enough for the widest kernel (simdsort4x8)
+	for (int sorted = 0; sorted < 2; ++sorted) {
+		// throughput: independent arrays, back to back
+		uint64_t best = ~0ULL;
+		for (int rep = 0; rep < REPS; ++rep) {
+			lcg_state = 0x12345678U;
+			fill(buf, n, ARRAYS, sorted != 0);
+			const uint64_t t0 = tic();
+			for (size_t i = 0; i < ARRAYS; ++i)
+				f(buf + n * i);
+			const uint64_t t1 = tic();
+			best = std::min(best, t1 - t0);
+		}
+		const double tput = static_cast<double>(best) / ARRAYS;
+
+		// latency: each input perturbed by the previous output so the
+		// calls form one dependency chain
+		best = ~0ULL;
+		for (int rep = 0; rep < REPS; ++rep) {
+			lcg_state = 0x12345678U;
+			fill(buf, n, ARRAYS, sorted != 0);
+			T carry = 0;
+			const uint64_t t0 = tic();
+			for (size_t i = 0; i < ARRAYS; ++i) {
+				T* const a = buf + n * i;
+				a[0] = static_cast<T>(a[0] + (carry & 1));
+				f(a);
+				carry = a[0];
+			}
+			const uint64_t t1 = tic();
+			best = std::min(best, t1 - t0);
+		}
+		const double lat = static_cast<double>(best) / ARRAYS;
+
+		printf("%-24s %-7s | tput %7.2f cyc/array (%5.2f /elem) | lat %7.2f cyc/array\n",
+			name, sorted ? "sorted" : "random", tput, tput / n, lat);
+	}
+}
+
+int main() {
+	printf("%zu arrays per pass, best of %d reps, fixed seed\n\n", ARRAYS, REPS);
+
+	// the explicit casts pick the in-place overloads
+	bench<int>("sort2", 2, sort2);
+	bench<int>("sort6", 6, static_cast<void (*)(int*)>(sort6));
+	bench<int>("sort6_stable", 6, sort6_stable);
+	bench<int>("simdsort4", 4, static_cast<void (*)(int*)>(simdsort4));
+	bench<int>("simdsort4_nofloat", 4, simdsort4_nofloat);
+	bench<int>("simdsort4_noconstants", 4, simdsort4_noconstants);
+	bench<int>("simdsort4_best", 4, simdsort4_best);
+	bench<char>("simdsort6", 6, static_cast<void (*)(char*)>(simdsort6));
+	bench<char>("simdsort6_noconstants", 6, simdsort6_noconstants);
+	bench<char>("simdsort6_stable", 6, simdsort6_stable);
+	bench<int>("simdsort8", 8, simdsort8);
+	bench<int>("simdsort16", 16, simdsort16);
+	bench<int>("simdsort4_batch(x1)", 4, [](int* v) { simdsort4_batch(v, 1); });
+#ifdef __AVX2__
+	bench<int>("simdsort4x8", 32, simdsort4x8);
+#endif
+
+	// whole-batch calls: one invocation sorts everything, so report it
+	// as one giant "array" and divide by hand
+	{
+		static int buf[4 * ARRAYS];
+		uint64_t best = ~0ULL;
+		for (int rep = 0; rep < REPS; ++rep) {
+			lcg_state = 0x12345678U;
+			fill(buf, 4, ARRAYS, false);
+			const uint64_t t0 = tic();
+			simdsort4_batch(buf, ARRAYS);
+			const uint64_t t1 = tic();
+			best = std::min(best, t1 - t0);
+		}
+		const double c = static_cast<double>(best) / ARRAYS;
+		printf("%-24s %-7s | tput %7.2f cyc/array (%5.2f /elem)\n",
+			"simdsort4_batch(full)", "random", c, c / 4);
+	}
+	{
+		static int buf[4 * ARRAYS];
+		uint64_t best = ~0ULL;
+		for (int rep = 0; rep < REPS; ++rep) {
+			lcg_state = 0x12345678U;
+			fill(buf, 4, ARRAYS, false);
+			const uint64_t t0 = tic();
+			simdsort4_batch_stream(buf, ARRAYS);
+			const uint64_t t1 = tic();
+			best = std::min(best, t1 - t0);
+		}
+		const double c = static_cast<double>(best) / ARRAYS;
+		printf("%-24s %-7s | tput %7.2f cyc/array (%5.2f /elem)\n",
+			"simdsort4_batch_stream", "random", c, c / 4);
+	}
+	{
+		static char buf[6 * ARRAYS];
+		uint64_t best = ~0ULL;
+		for (int rep = 0; rep < REPS; ++rep) {
+			lcg_state = 0x12345678U;
+			fill(buf, 6, ARRAYS, false);
+			const uint64_t t0 = tic();
+			simdsort6_batch(buf, ARRAYS);
+			const uint64_t t1 = tic();
+			best = std::min(best, t1 - t0);
+		}
+		const double c = static_cast<double>(best) / ARRAYS;
+		printf("%-24s %-7s | tput %7.2f cyc/array (%5.2f /elem)\n",
+			"simdsort6_batch(full)", "random", c, c / 6);
+	}
+
+#ifdef BENCH_ASM_KERNELS
+	bench<int>("sort2a", 2, sort2a);
+	bench<int>("sort3a", 3, sort3a);
+	bench<int>("sort4a", 4, sort4a);
+	bench<int>("sort5a", 5, sort5a);
+	bench<int>("sort6a", 6, sort6a);
+	bench<int>("sort8a", 8, sort8a);
+	bench<int>("sort16a", 16, sort16a);
+	bench<int>("simdsort4a", 4, simdsort4a);
+	bench<int>("simdsort4a_noconstants", 4, simdsort4a_noconstants);
+	bench<int>("simdsort4a_nofloat", 4, simdsort4a_nofloat);
+#endif
+
+	return 0;
+}
@@ -0,0 +1,181 @@
+/*******************************************************************
+*   dispatch.cpp
+*   Sorting Networks
+*
+*	Author: Kareem Omar
+*	kareem.omar@uah.edu
+*	https://github.com/komrad36
+*
+*	Last updated Aug 26, 2026
+*******************************************************************/
+//
+// Runtime CPU dispatch for the kernels in sorts.cpp, so one binary
+// can ship to a mixed fleet (Broadwell through Sapphire Rapids and
+// beyond) and every host runs the best kernel it supports.
+//
+// The mechanism is deliberately boring: a CPUID/XGETBV probe runs
+// exactly once, during static initialization, and the results are
+// baked into const function pointers (simdsort4_best and friends,
+// declared in sorts.h). After that a dispatched call is one indirect
+// call - no per-call branch, no atomic, no lazy-init check. This is
+// the same cost profile as ELF ifunc resolution but portable to MSVC
+// and to static initialization order on all three major compilers.
+//
+// Selection logic:
+//
+//   simdsort4_best        AVX + Skylake-or-newer  -> simdsort4()
+//                         (the permutevar version; on pre-Skylake
+//                         cores the int->float bypass latency eats
+//                         the win, so those get the pshufb version)
+//                         SSE4 only, or old core  -> simdsort4_nofloat()
+//                         neither                 -> scalar network
+//   simdsort6_best        SSE4                    -> simdsort6()
+//                         else                    -> scalar network
+//   simdsort4_batch_best  verifies the ISA the batch path was
+//   simdsort6_batch_best  *compiled* for is actually present (the
+//                         AVX-512 paths are selected by #ifdef at
+//                         build time), else falls back to a loop over
+//                         the single-array pointer above
+//
+// "Skylake or newer" is the usual family 6 / model >= 0x4E check; it
+// is a heuristic, and simdsort4()/simdsort4_nofloat() both stay
+// public so you can bind whichever profiles faster on your part.
+//
+// One caveat worth stating plainly: dispatch can only protect you
+// from instructions the compiler was told about. Compile this file
+// and sorts.cpp with the same flags, and keep the build baseline at
+// the oldest ISA in your fleet - if you build everything -mavx512f,
+// the compiler is free to put AVX-512 anywhere and no runtime check
+// can save you on a Broadwell.
+//
+
+#include "sorts.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+static void cpuid(int leaf, int sub, int out[4]) {
+	__cpuidex(out, leaf, sub);
+}
+static uint64_t xgetbv0() {
+	return _xgetbv(0);
+}
+#else
+#include <cpuid.h>
+static void cpuid(int leaf, int sub, int out[4]) {
+	unsigned a = 0, b = 0, c = 0, d = 0;
+	__get_cpuid_count(static_cast<unsigned>(leaf), static_cast<unsigned>(sub), &a, &b, &c, &d);
+	out[0] = static_cast<int>(a); out[1] = static_cast<int>(b);
+	out[2] = static_cast<int>(c); out[3] = static_cast<int>(d);
+}
+static uint64_t xgetbv0() {
+	uint32_t lo, hi;
+	__asm__ __volatile__("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+	return (static_cast<uint64_t>(hi) << 32) | lo;
+}
+#endif
+
+struct CpuFeatures {
+	bool sse4;
+	bool avx;
+	bool avx2;
+	bool avx512f;
+	bool avx512bw;
+	bool avx512vbmi;
+	bool skylake_or_newer;
+};
+
+static CpuFeatures probe() {
+	CpuFeatures f = {};
+	int r[4];
+
+	cpuid(0, 0, r);
+	const int max_leaf = r[0];
+	if (max_leaf < 1)
+		return f;
+
+	cpuid(1, 0, r);
+	const uint32_t ecx1 = static_cast<uint32_t>(r[2]);
+	f.sse4 = (ecx1 & (1U << 19)) != 0;	// SSE4.1 covers everything we emit
+	const bool osxsave = (ecx1 & (1U << 27)) != 0;
+	const uint64_t xcr0 = osxsave ? xgetbv0() : 0;
+	const bool ymm_saved = (xcr0 & 0x6) == 0x6;
+	const bool zmm_saved = (xcr0 & 0xe6) == 0xe6;
+	f.avx = ymm_saved && (ecx1 & (1U << 28)) != 0;
+
+	// family 6, model >= 0x4E (Skylake client) heuristic for the
+	// int->float bypass latency question. Models are eax[19:16]<<4 |
+	// eax[7:4] on family 6
+	const uint32_t eax1 = static_cast<uint32_t>(r[0]);
+	const uint32_t family = (eax1 >> 8) & 0xf;
+	const uint32_t model = ((eax1 >> 12) & 0xf0) | ((eax1 >> 4) & 0xf);
+	f.skylake_or_newer = family != 6 || model >= 0x4e;
+
+	if (max_leaf >= 7) {
+		cpuid(7, 0, r);
+		const uint32_t ebx7 = static_cast<uint32_t>(r[1]);
+		const uint32_t ecx7 = static_cast<uint32_t>(r[2]);
+		f.avx2 = f.avx && (ebx7 & (1U << 5)) != 0;
+		f.avx512f = zmm_saved && (ebx7 & (1U << 16)) != 0;
+		f.avx512bw = f.avx512f && (ebx7 & (1U << 30)) != 0;
+		f.avx512vbmi = f.avx512bw && (ecx7 & (1U << 1)) != 0;
+	}
+	return f;
+}
+
+static const CpuFeatures g_cpu = probe();
+
+// scalar last resorts, so the pointers are callable on anything
+static void sort4_scalar(int* __restrict v) {
+	sortN<4>(v);
+}
+static void sort6_scalar(char* __restrict v) {
+	sortN<6>(v);
+}
+
+static void (*resolve_simdsort4())(int* __restrict) {
+	// the casts pick the in-place overloads
+	if (g_cpu.avx && g_cpu.skylake_or_newer)
+		return static_cast<void (*)(int* __restrict)>(simdsort4);
+	if (g_cpu.sse4)
+		return simdsort4_nofloat;
+	return sort4_scalar;
+}
+
+static void (*resolve_simdsort6())(char* __restrict) {
+	return g_cpu.sse4 ? static_cast<void (*)(char* __restrict)>(simdsort6) : sort6_scalar;
+}
+
+void (*const simdsort4_best)(int* __restrict) = resolve_simdsort4();
+void (*const simdsort6_best)(char* __restrict) = resolve_simdsort6();
+
+// batch fallbacks: loop over the already-resolved single-array
+// pointer. Loses the pipelining/vertical win but stays correct
+static void batch4_loop(int* __restrict v, size_t count) {
+	for (size_t i = 0; i < count; ++i)
+		simdsort4_best(v + 4 * i);
+}
+static void batch6_loop(char* __restrict v, size_t count) {
+	for (size_t i = 0; i < count; ++i)
+		simdsort6_best(v + 6 * i);
+}
+
+static void (*resolve_simdsort4_batch())(int* __restrict, size_t) {
+#ifdef __AVX512F__
+	// the batch path in this build is the vertical zmm kernel
+	return g_cpu.avx512f ? simdsort4_batch : batch4_loop;
+#else
+	// the SSE batch path still uses permutevar, which is AVX
+	return g_cpu.avx ? simdsort4_batch : batch4_loop;
+#endif
+}
+
+static void (*resolve_simdsort6_batch())(char* __restrict, size_t) {
+#if defined(__AVX512VBMI__) && defined(__AVX512BW__)
+	return g_cpu.avx512vbmi ? simdsort6_batch : batch6_loop;
+#else
+	return g_cpu.sse4 ? simdsort6_batch : batch6_loop;
+#endif
+}
+
+void (*const simdsort4_batch_best)(int* __restrict, size_t) = resolve_simdsort4_batch();
+void (*const simdsort6_batch_best)(char* __restrict, size_t) = resolve_simdsort6_batch();
@@ -0,0 +1,227 @@
+/*******************************************************************
+*   medianfilter.h
+*   Sorting Networks
+*
+*	Author: Kareem Omar
+*	kareem.omar@uah.edu
+*	https://github.com/komrad36
+*
+*	Last updated Aug 26, 2026
+*******************************************************************/
+//
+// Sliding median filter engine built on the pruned median kernels.
+//
+// A median filter wants the median of every window of N consecutive
+// samples, which makes a full sort per window doubly wasteful: half
+// the comparators of the network compute order the caller never
+// reads (see the median4()/median5() discussion in sorts.h), and
+// adjacent windows share N - 1 of their N elements. This header
+// attacks the first waste with pruned median networks - median-of-5
+// is the classic 6-comparison selection, median-of-9 sorts its three
+// triples and takes the median of { max of the minima, median of the
+// middles, min of the maxima } - and the second with the batch API,
+// which doesn't slide at all: it computes WIDTH independent window
+// positions per pass in the vertical formulation, one comparator =
+// one min + one max across 4 (SSE) or 8 (AVX2) positions, so the
+// redundant work is amortized across lanes instead of being tracked
+// with bookkeeping.
+//
+// MedianFilter<N> is the streaming form for one sample at a time:
+// push() replaces the oldest sample and returns the new median. At
+// these window sizes recomputing the median through the pruned
+// network is cheaper than maintaining a sorted window - deleting and
+// inserting in sorted order costs about as many comparisons as the
+// whole median-of-5 and branches besides - so push() stays
+// branchless and constant-time instead of clever.
+//
+// Any N from 2 to 16 works (generic path: sortN on a window copy);
+// N = 5 and N = 9 take the pruned kernels. Even N returns the upper
+// median. Requires C++14, same as netsort.h.
+//
+
+#pragma once
+
+#include "sorts.h"
+
+namespace detail {
+
+// median of the N values in w (window order irrelevant). Generic
+// path: local copy through sortN, take the middle
+template <size_t N>
+inline int median_of(const int* __restrict w) {
+	int t[N];
+	for (size_t i = 0; i < N; ++i)
+		t[i] = w[i];
+	sortN<N>(t);
+	return t[N / 2];
+}
+
+template <>
+inline int median_of<5>(const int* __restrict w) {
+	return median5(w);
+}
+
+// median of 9 without sorting 9: sort the three triples with the
+// 3-element network, then the median of the whole window is the
+// median of { max of the three minima, median of the three middles,
+// min of the three maxima } - 6 comparators per triple-sort stage
+// done as min/max, no data movement
+template <>
+inline int median_of<9>(const int* __restrict w) {
+#define __kmin(a, b) (a < b ? a : b)
+#define __kmax(a, b) (a < b ? b : a)
+#define __ksort3(a, b, c, lo, mid, hi) \
+	const int t##lo = __kmin(a, b); const int t##hi = __kmax(a, b); \
+	const int lo = __kmin(t##lo, c); const int mid = __kmax(t##lo, __kmin(t##hi, c)); const int hi = __kmax(t##hi, c);
+	__ksort3(w[0], w[1], w[2], l0, m0, h0);
+	__ksort3(w[3], w[4], w[5], l1, m1, h1);
+	__ksort3(w[6], w[7], w[8], l2, m2, h2);
+	const int lo = __kmax(__kmax(l0, l1), l2);
+	const int mid = __kmax(__kmin(m0, m1), __kmin(__kmax(m0, m1), m2));
+	const int hi = __kmin(__kmin(h0, h1), h2);
+	return __kmax(__kmin(lo, mid), __kmin(__kmax(lo, mid), hi));
+#undef __ksort3
+#undef __kmax
+#undef __kmin
+}
+
+// batch core: out[i] = median(in[i .. i+N-1]) for the n - N + 1 full
+// windows. Generic path is the scalar kernel per position
+template <size_t N>
+inline void median_filter_batch(const int* __restrict in, int* __restrict out, size_t n) {
+	for (size_t i = 0; i + N <= n; ++i)
+		out[i] = median_of<N>(in + i);
+}
+
+// vertical median-of-5: five shifted loads put sample k of WIDTH
+// consecutive windows in lane position k, and the 6-comparison
+// selection runs as plain min/max across all of them at once
+template <>
+inline void median_filter_batch<5>(const int* __restrict in, int* __restrict out, size_t n) {
+	if (n < 5)
+		return;
+	const size_t count = n - 4;
+	size_t i = 0;
+#ifdef __AVX2__
+	for (; i + 8 <= count; i += 8) {
+		const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+		const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 1));
+		const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 2));
+		const __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 3));
+		const __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + 4));
+		const __m256i f = _mm256_max_epi32(_mm256_min_epi32(a, b), _mm256_min_epi32(c, d));
+		const __m256i g = _mm256_min_epi32(_mm256_max_epi32(a, b), _mm256_max_epi32(c, d));
+		const __m256i med = _mm256_max_epi32(_mm256_min_epi32(e, f),
+			_mm256_min_epi32(_mm256_max_epi32(e, f), g));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), med);
+	}
+#endif
+	for (; i + 4 <= count; i += 4) {
+		const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+		const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 1));
+		const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 2));
+		const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 3));
+		const __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 4));
+		const __m128i f = _mm_max_epi32(_mm_min_epi32(a, b), _mm_min_epi32(c, d));
+		const __m128i g = _mm_min_epi32(_mm_max_epi32(a, b), _mm_max_epi32(c, d));
+		const __m128i med = _mm_max_epi32(_mm_min_epi32(e, f),
+			_mm_min_epi32(_mm_max_epi32(e, f), g));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), med);
+	}
+	for (; i < count; ++i)
+		out[i] = median_of<5>(in + i);
+}
+
+// vertical median-of-9: same triple-sort formulation as the scalar
+// kernel, all min/max
+template <>
+inline void median_filter_batch<9>(const int* __restrict in, int* __restrict out, size_t n) {
+	if (n < 9)
+		return;
+	const size_t count = n - 8;
+	size_t i = 0;
+#ifdef __AVX2__
+#define __vsort3(a, b, c, lo, mid, hi) \
+	const __m256i lo##t = _mm256_min_epi32(a, b); const __m256i hi##t = _mm256_max_epi32(a, b); \
+	const __m256i lo = _mm256_min_epi32(lo##t, c); \
+	const __m256i mid = _mm256_max_epi32(lo##t, _mm256_min_epi32(hi##t, c)); \
+	const __m256i hi = _mm256_max_epi32(hi##t, c);
+	for (; i + 8 <= count; i += 8) {
+		__m256i s[9];
+		for (int k = 0; k < 9; ++k)
+			s[k] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i + k));
+		__vsort3(s[0], s[1], s[2], l0, m0, h0);
+		__vsort3(s[3], s[4], s[5], l1, m1, h1);
+		__vsort3(s[6], s[7], s[8], l2, m2, h2);
+		const __m256i lo = _mm256_max_epi32(_mm256_max_epi32(l0, l1), l2);
+		const __m256i mid = _mm256_max_epi32(_mm256_min_epi32(m0, m1),
+			_mm256_min_epi32(_mm256_max_epi32(m0, m1), m2));
+		const __m256i hi = _mm256_min_epi32(_mm256_min_epi32(h0, h1), h2);
+		const __m256i med = _mm256_max_epi32(_mm256_min_epi32(lo, mid),
+			_mm256_min_epi32(_mm256_max_epi32(lo, mid), hi));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), med);
+	}
+#undef __vsort3
+#endif
+#define __vsort3(a, b, c, lo, mid, hi) \
+	const __m128i lo##t = _mm_min_epi32(a, b); const __m128i hi##t = _mm_max_epi32(a, b); \
+	const __m128i lo = _mm_min_epi32(lo##t, c); \
+	const __m128i mid = _mm_max_epi32(lo##t, _mm_min_epi32(hi##t, c)); \
+	const __m128i hi = _mm_max_epi32(hi##t, c);
+	for (; i + 4 <= count; i += 4) {
+		__m128i s[9];
+		for (int k = 0; k < 9; ++k)
+			s[k] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + k));
+		__vsort3(s[0], s[1], s[2], l0, m0, h0);
+		__vsort3(s[3], s[4], s[5], l1, m1, h1);
+		__vsort3(s[6], s[7], s[8], l2, m2, h2);
+		const __m128i lo = _mm_max_epi32(_mm_max_epi32(l0, l1), l2);
+		const __m128i mid = _mm_max_epi32(_mm_min_epi32(m0, m1),
+			_mm_min_epi32(_mm_max_epi32(m0, m1), m2));
+		const __m128i hi = _mm_min_epi32(_mm_min_epi32(h0, h1), h2);
+		const __m128i med = _mm_max_epi32(_mm_min_epi32(lo, mid),
+			_mm_min_epi32(_mm_max_epi32(lo, mid), hi));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), med);
+	}
+#undef __vsort3
+	for (; i < count; ++i)
+		out[i] = median_of<9>(in + i);
+}
+
+}	// namespace detail
+
+template <size_t N>
+class MedianFilter {
+	static_assert(N >= 2 && N <= 16, "MedianFilter: no network defined for this N");
+
+	int w[N];
+	size_t head;
+
+public:
+	// the window starts filled with 'seed' (default 0), the usual
+	// edge-handling convention for streaming filters
+	explicit MedianFilter(int seed = 0) {
+		reset(seed);
+	}
+
+	void reset(int seed) {
+		head = 0;
+		for (size_t i = 0; i < N; ++i)
+			w[i] = seed;
+	}
+
+	// replace the oldest sample with x, return the window median
+	int push(int x) {
+		w[head] = x;
+		head = head + 1 == N ? 0 : head + 1;
+		return detail::median_of<N>(w);
+	}
+
+	// batch form for when the samples are already in memory:
+	// out[i] = median(in[i .. i+N-1]), writing the n - N + 1 full
+	// windows. Does not touch or share the streaming state, and
+	// vectorizes across window positions for N = 5 and N = 9
+	static void filter(const int* __restrict in, int* __restrict out, size_t n) {
+		detail::median_filter_batch<N>(in, out, n);
+	}
+};
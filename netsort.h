@@ -0,0 +1,165 @@
+/*******************************************************************
+*   netsort.h
+*   Sorting Networks
+*
+*	Author: Kareem Omar
+*	kareem.omar@uah.edu
+*	https://github.com/komrad36
+*
+*	Last updated Aug 26, 2026
+*******************************************************************/
+//
+// Compile-time generator for the runtime-shuffle-mask kernels.
+//
+// simdsort4() and simdsort6() were each a manual derivation: work out
+// the parallel levels of the network, then hand-craft per-pass
+// shuffle/and/add constants that turn the compare result into a
+// permutation. That doesn't scale - every new (N, element width)
+// combination is a fresh derivation. This header automates it.
+// netsort<N, T>() takes any comparator network expressed as pairs
+// (it uses the detail::network<N> tables from sorts.h) and any signed
+// element type whose N elements fit in one xmm register, and emits
+// the same style of kernel the hand versions use:
+//
+//     b = pshufb(a, partner)   gather each element's partner
+//     b = pcmpgt(b, a)         partner > self, at element width
+//     b = pand(b, delta)       scale the mask to the swap distance
+//     b = psubb(base, b)       byte indices: partner normally,
+//                              self when the compare fired
+//     a = pshufb(a, b)         apply one whole level of the network
+//
+// The constants come from a constexpr pass over the pair list that
+// greedily packs consecutive independent comparators into levels, so
+// the level structure (and instruction count) matches what you'd
+// derive by hand: 3 levels for the n = 4 network, 5 for n = 6. The
+// encoding is uniform - for a pair (i, j) both lanes carry base j and
+// delta (j - i), in bytes - rather than each kernel's bespoke
+// folding, but the passes it produces sort identically to
+// simdsort4()/simdsort6() (and the hand kernels remain the ones to
+// beat; this generator is for the combinations nobody has hand-tuned
+// yet - n = 5, 7, 8, the int16_t variants, and so on).
+//
+// As with the other key-only kernels, ties can gather the same source
+// lane twice - harmless for plain values, NOT safe for key+payload.
+// Use the kv kernels for that.
+//
+// Requires C++14 (relaxed constexpr). Limits: N * sizeof(T) <= 16,
+// signed integral T of 1, 2, or 4 bytes.
+//
+
+#pragma once
+
+#include "sorts.h"
+
+#include <cstring>
+
+namespace detail {
+
+// one level = one pshufb/pcmpgt/pand/psubb/pshufb pass; constants are
+// byte-granular so the same machinery serves every element width
+struct netsort_level {
+	uint8_t partner[16];
+	uint8_t base[16];
+	uint8_t delta[16];
+};
+
+template <size_t N, size_t S>
+struct netsort_plan {
+	static constexpr size_t MAXLEVELS = sizeof(network<N>::pairs) / 2;
+	netsort_level lv[MAXLEVELS];
+	size_t count;
+
+	constexpr netsort_plan() : lv{}, count(0) {
+		// element-granular state for the level being packed
+		uint8_t partner[16] = {};
+		uint8_t base[16] = {};
+		uint8_t delta[16] = {};
+		bool used[16] = {};
+		bool open = false;
+
+		for (size_t e = 0; e < 16; ++e) {
+			partner[e] = static_cast<uint8_t>(e);
+			base[e] = static_cast<uint8_t>(e);
+		}
+
+		for (size_t c = 0; c < sizeof(network<N>::pairs) / 2; ++c) {
+			const size_t i = network<N>::pairs[c][0];
+			const size_t j = network<N>::pairs[c][1];
+			if (used[i] || used[j]) {
+				flush(partner, base, delta, used);
+				open = false;
+			}
+			partner[i] = static_cast<uint8_t>(j);
+			partner[j] = static_cast<uint8_t>(i);
+			base[i] = base[j] = static_cast<uint8_t>(j);
+			delta[i] = delta[j] = static_cast<uint8_t>(j - i);
+			used[i] = used[j] = true;
+			open = true;
+		}
+		if (open)
+			flush(partner, base, delta, used);
+	}
+
+private:
+	// widen the element-granular level to bytes and reset it
+	constexpr void flush(uint8_t* partner, uint8_t* base, uint8_t* delta, bool* used) {
+		for (size_t b = 0; b < 16; ++b) {
+			const size_t e = b / S;
+			const size_t k = b % S;
+			lv[count].partner[b] = static_cast<uint8_t>(partner[e] * S + k);
+			lv[count].base[b] = static_cast<uint8_t>(base[e] * S + k);
+			lv[count].delta[b] = static_cast<uint8_t>(delta[e] * S);
+		}
+		++count;
+		for (size_t e = 0; e < 16; ++e) {
+			partner[e] = static_cast<uint8_t>(e);
+			base[e] = static_cast<uint8_t>(e);
+			delta[e] = 0;
+			used[e] = false;
+		}
+	}
+};
+
+template <size_t N, size_t S>
+struct netsort_plan_holder {
+	static constexpr netsort_plan<N, S> plan = netsort_plan<N, S>();
+};
+template <size_t N, size_t S>
+constexpr netsort_plan<N, S> netsort_plan_holder<N, S>::plan;
+
+}	// namespace detail
+
+// register-to-register core. The level count is a compile-time
+// constant, so the loop fully unrolls and each level's constants
+// become rip-relative loads, same as the hand kernels
+template <size_t N, typename T>
+__m128i netsort_reg(__m128i a) {
+	static_assert(N >= 2 && N * sizeof(T) <= 16, "N elements must fit in one xmm register");
+	static_assert(static_cast<T>(-1) < static_cast<T>(0) && (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4),
+		"T must be a signed 1-, 2-, or 4-byte integer");
+	const detail::netsort_plan<N, sizeof(T)>& plan = detail::netsort_plan_holder<N, sizeof(T)>::plan;
+	for (size_t l = 0; l < plan.count; ++l) {
+		const detail::netsort_level& lv = plan.lv[l];
+		__m128i b = _mm_shuffle_epi8(a, _mm_loadu_si128(reinterpret_cast<const __m128i*>(lv.partner)));
+		b = sizeof(T) == 1 ? _mm_cmpgt_epi8(b, a) :
+			sizeof(T) == 2 ? _mm_cmpgt_epi16(b, a) :
+			_mm_cmpgt_epi32(b, a);
+		b = _mm_and_si128(b, _mm_loadu_si128(reinterpret_cast<const __m128i*>(lv.delta)));
+		b = _mm_sub_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(lv.base)), b);
+		a = _mm_shuffle_epi8(a, b);
+	}
+	return a;
+}
+
+template <size_t N, typename T>
+void netsort(T* __restrict v) {
+	uint8_t buf[16] = {};
+	__m128i a;
+	// exact-size copies so no bytes past v[N-1] are touched; compilers
+	// turn these into the obvious loads/stores
+	memcpy(buf, v, N * sizeof(T));
+	memcpy(&a, buf, 16);
+	a = netsort_reg<N, T>(a);
+	memcpy(buf, &a, 16);
+	memcpy(v, buf, N * sizeof(T));
+}
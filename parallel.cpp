@@ -0,0 +1,78 @@
+/*******************************************************************
+*   parallel.cpp
+*   Sorting Networks
+*
+*	Author: Kareem Omar
+*	kareem.omar@uah.edu
+*	https://github.com/komrad36
+*
+*	Last updated Aug 26, 2026
+*******************************************************************/
+//
+// Multithreaded driver for the batch kernels, for when one core's
+// worth of simdsort4_batch() is not enough and you want the whole
+// socket. Every record is independent, so this is embarrassingly
+// parallel; the only interesting decisions are chunking and
+// scheduling:
+//
+//   - chunks are whole multiples of 4 records. A record is 16 bytes,
+//     so 4 records fill one 64-byte cache line; keeping chunk
+//     boundaries on record-group granularity means two workers never
+//     write the same line and there is no false sharing (provided the
+//     base pointer is 64-byte aligned - if yours isn't, at worst the
+//     two lines at each chunk seam ping-pong once).
+//
+//   - scheduling is dynamic: workers claim the next chunk from a
+//     shared atomic counter as they finish the previous one. Static
+//     partitioning looks cheaper but scales badly in practice when
+//     pages fault in unevenly or a core gets preempted - the slow
+//     worker strands a fixed fraction of the job. With self-
+//     scheduled chunks the fast workers simply eat the remainder.
+//     One uncontended fetch_add per 1024 records is noise.
+//
+// This file is plain C++11 <thread>/<atomic>; it lives in its own
+// translation unit so builds that don't want a threading dependency
+// can just not compile it (sorts.cpp stays dependency-free).
+//
+
+#include "sorts.h"
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+// 1024 records = 16 KB per claim: big enough that the atomic and the
+// call overhead vanish, small enough to load-balance tail effects
+static const size_t CHUNK = 1024;
+
+void simdsort4_batch_parallel(int* __restrict v, size_t count, size_t threads) {
+	if (threads == 0)
+		threads = std::thread::hardware_concurrency();
+	// below ~2 chunks per worker the fork/join overhead is the whole
+	// story; just run it here
+	if (threads <= 1 || count < 2 * CHUNK) {
+		simdsort4_batch(v, count);
+		return;
+	}
+	if (threads > count / CHUNK)
+		threads = count / CHUNK;
+
+	std::atomic<size_t> next(0);
+	auto worker = [&] {
+		for (;;) {
+			const size_t i = next.fetch_add(CHUNK, std::memory_order_relaxed);
+			if (i >= count)
+				return;
+			const size_t n = count - i < CHUNK ? count - i : CHUNK;
+			simdsort4_batch(v + 4 * i, n);
+		}
+	};
+
+	std::vector<std::thread> pool;
+	pool.reserve(threads - 1);
+	for (size_t t = 1; t < threads; ++t)
+		pool.emplace_back(worker);
+	worker();
+	for (auto& th : pool)
+		th.join();
+}
@@ -0,0 +1,115 @@
+/*******************************************************************
+*   profile.cpp
+*   Sorting Networks
+*
+*	Author: Kareem Omar
+*	kareem.omar@uah.edu
+*	https://github.com/komrad36
+*
+*	Last updated Aug 26, 2026
+*******************************************************************/
+//
+// Storage and dump side of the SIMDSORT_PROFILE hooks (see profile.h
+// for the design). Each thread gets its own histogram block, heap-
+// allocated on first use and chained into a global registry under a
+// mutex - the mutex is touched once per thread lifetime, never on the
+// recording path. Blocks are deliberately never freed: a thread that
+// exits leaves its counts behind so simdsort_stats_dump() still sees
+// them, and the leak is one block per thread that ever sorted.
+//
+// This file is empty unless compiled with -DSIMDSORT_PROFILE, so it
+// can sit in the link line unconditionally, same as parallel.cpp for
+// builds that don't want <thread>.
+//
+
+#ifdef SIMDSORT_PROFILE
+
+#include "profile.h"
+
+#include <cstdio>
+#include <mutex>
+
+// log2 buckets: bucket b holds calls that took [2^b, 2^(b+1)) cycles
+static const int BUCKETS = 40;
+
+struct prof_block {
+	uint64_t calls[simdsort_prof_kernel_count];
+	uint64_t cycles[simdsort_prof_kernel_count];
+	uint64_t hist[simdsort_prof_kernel_count][BUCKETS];
+	prof_block* next;
+};
+
+static const char* const simdsort_prof_names[simdsort_prof_kernel_count] = {
+	"sort2",
+	"sort6",
+	"simdsort4",
+	"simdsort6",
+	"simdsort8",
+	"simdsort16",
+	"sort_small",
+	"simdsort4_batch",
+	"simdsort6_batch",
+};
+
+static std::mutex g_registry_mutex;
+static prof_block* g_blocks = nullptr;
+
+static thread_local prof_block* t_block = nullptr;
+
+static prof_block* register_block() {
+	prof_block* const b = new prof_block();
+	std::lock_guard<std::mutex> lock(g_registry_mutex);
+	b->next = g_blocks;
+	g_blocks = b;
+	t_block = b;
+	return b;
+}
+
+void simdsort_prof_record(int kernel, uint64_t cycles) {
+	prof_block* b = t_block;
+	if (!b)
+		b = register_block();
+	int bucket = 0;
+	while (bucket + 1 < BUCKETS && cycles >> (bucket + 1))
+		++bucket;
+	++b->calls[kernel];
+	b->cycles[kernel] += cycles;
+	++b->hist[kernel][bucket];
+}
+
+void simdsort_stats_dump() {
+	// aggregate across every thread's block; recording can continue
+	// concurrently, in which case the dump is a (harmless) torn
+	// snapshot
+	uint64_t calls[simdsort_prof_kernel_count] = {};
+	uint64_t cycles[simdsort_prof_kernel_count] = {};
+	uint64_t hist[simdsort_prof_kernel_count][BUCKETS] = {};
+	int threads = 0;
+	{
+		std::lock_guard<std::mutex> lock(g_registry_mutex);
+		for (const prof_block* b = g_blocks; b; b = b->next, ++threads) {
+			for (int k = 0; k < simdsort_prof_kernel_count; ++k) {
+				calls[k] += b->calls[k];
+				cycles[k] += b->cycles[k];
+				for (int i = 0; i < BUCKETS; ++i)
+					hist[k][i] += b->hist[k][i];
+			}
+		}
+	}
+
+	printf("simdsort profile: %d thread(s)\n", threads);
+	for (int k = 0; k < simdsort_prof_kernel_count; ++k) {
+		if (!calls[k])
+			continue;
+		printf("%-16s %12llu calls, %7.1f cyc/call | log2 cyc:",
+			simdsort_prof_names[k],
+			static_cast<unsigned long long>(calls[k]),
+			static_cast<double>(cycles[k]) / static_cast<double>(calls[k]));
+		for (int i = 0; i < BUCKETS; ++i)
+			if (hist[k][i])
+				printf(" %d:%llu", i, static_cast<unsigned long long>(hist[k][i]));
+		printf("\n");
+	}
+}
+
+#endif
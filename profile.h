@@ -0,0 +1,84 @@
+/*******************************************************************
+*   profile.h
+*   Sorting Networks
+*
+*	Author: Kareem Omar
+*	kareem.omar@uah.edu
+*	https://github.com/komrad36
+*
+*	Last updated Aug 26, 2026
+*******************************************************************/
+//
+// Opt-in perf-counter hooks for the kernel entry points, so codegen
+// regressions (a compiler upgrade turning the sort6 cmovs back into
+// branches, say) show up in your own telemetry instead of weeks later
+// in fleet dashboards.
+//
+// Off by default and completely free when off: the SIMDSORT_PROF()
+// macro expands to nothing, so the kernels compile exactly as before.
+// Compile everything with -DSIMDSORT_PROFILE and link profile.cpp to
+// turn it on; each instrumented entry point then records an rdtscp
+// delta into a per-thread, per-kernel histogram of log2(cycles)
+// buckets held in thread-local storage - no atomics or sharing on the
+// hot path, just two timestamp reads, a bsr and an increment (the
+// rdtscp pair itself is the bulk of the cost, a few tens of cycles,
+// which is why this is a canary-shard switch and not an always-on
+// one). simdsort_stats_dump() aggregates every thread's histograms
+// and prints cycles/call distributions to stdout.
+//
+// Instrumented entry points: sort2, sort6, simdsort4, simdsort6,
+// simdsort8, simdsort16, sort_small, simdsort4_batch and
+// simdsort6_batch (batch kernels record cycles for the whole call, so
+// divide by the batch size when reading those rows).
+//
+
+#pragma once
+
+// kernel ids; must stay in sync with simdsort_prof_names in profile.cpp
+enum simdsort_prof_kernel {
+	simdsort_prof_sort2,
+	simdsort_prof_sort6,
+	simdsort_prof_simdsort4,
+	simdsort_prof_simdsort6,
+	simdsort_prof_simdsort8,
+	simdsort_prof_simdsort16,
+	simdsort_prof_sort_small,
+	simdsort_prof_simdsort4_batch,
+	simdsort_prof_simdsort6_batch,
+	simdsort_prof_kernel_count
+};
+
+#ifdef SIMDSORT_PROFILE
+
+#include <cstdint>
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+
+void simdsort_prof_record(int kernel, uint64_t cycles);
+void simdsort_stats_dump();
+
+// scoped timer: construct at kernel entry, records on scope exit
+struct simdsort_prof_scope {
+	int kernel;
+	uint64_t start;
+	unsigned aux;
+
+	explicit simdsort_prof_scope(int k) : kernel(k), start(__rdtscp(&aux)) {}
+	~simdsort_prof_scope() {
+		simdsort_prof_record(kernel, __rdtscp(&aux) - start);
+	}
+};
+
+#define SIMDSORT_PROF(k) simdsort_prof_scope __simdsort_prof_scope(simdsort_prof_##k)
+
+#else
+
+inline void simdsort_stats_dump() {}
+
+#define SIMDSORT_PROF(k) ((void)0)
+
+#endif
@@ -1,306 +1,1852 @@
-/*******************************************************************
-*   sorts.cpp
-*   Sorting Networks
-*
-*	Author: Kareem Omar
-*	kareem.omar@uah.edu
-*	https://github.com/komrad36
-*
-*	Last updated Feb 15, 2017
-*******************************************************************/
-//
-// SUMMARY: I present novel and state-of-the-art sorting of 4 int32_t
-// and sorting of 6 int8_t, as examples, using SSE4, and some thoughts
-// and notes on fast sorting of small fixed-size arrays.
-//
-// These are the fastest known approaches on modern CPUs.
-// They are completely branchless and extremely fast.
-// For example, 4 int32_t can be sorted in ~18 cycles on Skylake.
-//
-// These examples can be modified to sort signed or unsigned data as long
-// as the total size of the data is <= 128 bits (16 bytes). Note that
-// trying to use AVX2 to push that to 256 bits will NOT HELP
-// because of the 3 cycle interlane latency that makes shuffling
-// across the 128-bit lane boundary too expensive to be useful.
-//
-// In that case, or in the case that you can't support SSE4,
-// efficient scalar code can also be generated that isn't too much
-// slower, but it's not immediately evident what the optimal approach
-// is in assembly, nor how to coerce C/C++ compilers to produce that
-// assembly from C/C++ code. (I discuss the approach at the end of this
-// documentation.)
-//
-// Not all compilers correctly generate optimal assembly for either the
-// SSE or scalar code, so I provide assembly versions too. In fact, this
-// is not a strong enough statement; many compilers FAIL MISERABLY
-// at both the SSE and scalar cases for n >= 3. CL in particular
-// (Microsoft Visual C++) just dies horribly in a fire, so the assembly
-// snippets may not be a bad idea. Profile and/or check your disassembly.
-//
-// Note that these assembly snippets use the Windows x64 calling convention,
-// but then proceed to clobber a bunch of registers they shouldn't. Normally
-// they'd be inlined. Feel free to callee-save registers that your
-// application cannot safely clobber.
-//
-// These code snippets work on the principle of sorting networks.
-// Conventional sorting algorithms like quicksort and mergesort
-// are not great at small array sizes. One notices in profiling that
-// simpler sorts like insertion and selection tend to win. However,
-// even these are not NEARLY as fast as they could be for
-// fixed-size, small arrays.
-//
-// Available sorts and their function names:
-//
-// >>> SSE Assembly (fast as hell. FASTEST option on modern CPUs.
-//					 these are written in MASM for Win64;
-//					 but it's Intel syntax and you can make the small
-//					 modifications required for other assemblers.)
-// Sorting 4 int32_t  |  simdsort4a()
-// Sorting 4 int32_t  |  simdsort4a_noconstants()
-// Sorting 4 int32_t  |  simdsort4a_nofloat()
-//
-// >>> SSE C++ (make sure generated assembly matches):
-// Sorting 4 int32_t  |  simdsort4()
-// Sorting 6 int8_t   |  simdsort6()
-//
-// >>> Scalar Assembly (these are written in MASM for Win64;
-//						but it's Intel syntax and you can make the small
-//						modifications required for other assemblers.)
-// Sorting 2 int32_t  |  sort2a()
-// Sorting 3 int32_t  |  sort3a()
-// Sorting 4 int32_t  |  sort4a()
-// Sorting 5 int32_t  |  sort5a()
-// Sorting 6 int32_t  |  sort6a()
-//
-// >>> Scalar C++ (make sure generated assembly matches)
-// Sorting 2 int32_t  |  sort2()
-// Sorting 6 int32_t  |  sort6()
-//
-//
-// Okay, if you've made it this far, let's discuss
-// fast conditional swap operations.Conditional swaps
-// if the lower element is greater are the heart of sorting
-// networks.Given two values,
-// 'a', and 'b', leave them as they are if 'a' is less
-// than 'b', i.e. if they are in sorted order.However,
-// swap them if 'a' is greater than or equal to 'b'.
-// Thus after such a conditional swap operation 'a' and 'b' are in sorted
-// order no matter what order they came in as.
-//
-// A series of such operations can deterministically sort
-// a fixed - size array. Typically one can optimize for depth
-// (minimum number of operations given infinite parallel
-// processing) or for size (minimum number of operations given
-// no parallel processing). For n == 4 these two optimal solutions
-// are actually given by the same network, with depth 3 and
-// size 5.
-//
-// Scalar first : how do you efficiently conditional swap ? Again, note that
-// lots of compilers don't produce optimal assembly no matter
-// what C++ you give them.But what is the optimal assembly ?
-// Well, on modern processors, the answer is conditional moves :
-//
-// ; inputs: eax, r9d
-// ; scratch register: edx
-//	cmp     eax, r9d
-//	mov     edx, eax
-//	cmovg   eax, r9d
-//	cmovg   r9d, edx
-// ; eax and r9d have been swapped if necessary such that eax is now <= r9d
-//
-// See the function 'sort6' in 'sorts.cpp' for an attempt at some C++ code
-// that has a decent chance of compiling into conditional swaps that look like that.
-// Again, they OFTEN DON'T, especially the CL compiler and g++. Use the assembly
-// snippets instead, or at least profile and inspect your disassembly to be sure.
-//
-// The SSE sorts are rather more sophisticated, but the basic principle
-// is to branchlessly generate shuffle index masks at runtime and then
-// use them to permute the order of the data in parallel, performing
-// one complete level of the sorting network at a time.
-//
-// I provide 3 versions of the assembly for sorting 4 int32_t. The fastest
-// should be the plain 'simdsort4a'. It performs float reinterpretation
-// and relies on some constant loads, but both of these are USUALLY
-// better than the alternatives. However:
-//
-// Older CPUs may incur too much latency from the reinterpretation to be
-// worth it. For such CPUs, try 'simdsort4a_nofloat.asm'.
-//
-// Applications that cannot afford to have these constants occupying L1
-// may wish to try 'simdsort4a_noconstants.asm', which does not eat
-// up any cache space with constants - everything is done with immediates
-// and some fairly nasty bit twiddling.
-//
-
-#include "sorts.h"
-
-void sort2(int* __restrict v) {
-	const int a = v[0];
-	const int b = v[1];
-	v[0] = b > a ? a : b;
-	v[1] = b > a ? b : a;
-}
-
-void sort6(int* __restrict v) {
-#define __kmin(a, b) (a < b ? a : b)
-#define __kmax(a, b) (a < b ? b : a)
-#define __kswap(x,y) { int a = __kmin(v[x], v[y]); int b = __kmax(v[x], v[y]); v[x] = a; v[y] = b; }
-	__kswap(1, 2);
-	__kswap(0, 2);
-	__kswap(0, 1);
-	__kswap(4, 5);
-	__kswap(3, 5);
-	__kswap(3, 4);
-	__kswap(0, 3);
-	__kswap(1, 4);
-	__kswap(2, 5);
-	__kswap(2, 4);
-	__kswap(1, 3);
-	__kswap(2, 3);
-#undef __kswap
-#undef __kmax
-#undef __kmin
-}
-
-// this is the 'no float' version
-//const __m128i pass1_add4s = _mm_setr_epi8(4, 5, 6, 7, 4, 5, 6, 7, 12, 13, 14, 15, 12, 13, 14, 15);
-//const __m128i pass2_add4s = _mm_setr_epi8(8, 9, 10, 11, 12, 13, 14, 15, 8, 9, 10, 11, 12, 13, 14, 15);
-//const __m128i pass3_add4s = _mm_setr_epi8(0, 1, 2, 3, 8, 9, 10, 11, 8, 9, 10, 11, 12, 13, 14, 15);
-//void simdsort4(int* __restrict v) {
-//	__m128i b, a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
-//
-//	b = _mm_shuffle_epi32(a, 177);
-//	b = _mm_cmpgt_epi32(b, a);
-//	b = _mm_and_si128(b, _mm_set1_epi8(-4));
-//	b = _mm_add_epi8(b, pass1_add4s);
-//	a = _mm_shuffle_epi8(a, b);
-//
-//	b = _mm_shuffle_epi32(a, 78);
-//	b = _mm_cmpgt_epi32(b, a);
-//	b = _mm_and_si128(b, _mm_set1_epi8(-8));
-//	b = _mm_add_epi8(b, pass2_add4s);
-//	a = _mm_shuffle_epi8(a, b);
-//
-//	b = _mm_shuffle_epi32(a, 216);
-//	b = _mm_cmpgt_epi32(b, a);
-//	b = _mm_and_si128(b, _mm_set1_epi8(-4));
-//	b = _mm_add_epi8(b, pass3_add4s);
-//	a = _mm_shuffle_epi8(a, b);
-//
-//	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), a);
-//}
-
-// this is the version that should be the fastest
-const __m128i pass1_add4 = _mm_setr_epi32(1, 1, 3, 3);
-const __m128i pass2_add4 = _mm_setr_epi32(2, 3, 2, 3);
-const __m128i pass3_add4 = _mm_setr_epi32(0, 2, 2, 3);
-void simdsort4(int* __restrict v) {
-	__m128i b, a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
-
-	b = _mm_shuffle_epi32(a, 177);
-	b = _mm_cmpgt_epi32(b, a);
-	b = _mm_add_epi32(b, pass1_add4);
-	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
-
-	b = _mm_shuffle_epi32(a, 78);
-	b = _mm_cmpgt_epi32(b, a);
-	b = _mm_add_epi32(b, b);
-	b = _mm_add_epi32(b, pass2_add4);
-	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
-
-	b = _mm_shuffle_epi32(a, 216);
-	b = _mm_cmpgt_epi32(b, a);
-	b = _mm_add_epi32(b, pass3_add4);
-	__m128 ret = _mm_permutevar_ps(_mm_castsi128_ps(a), b);
-
-	_mm_storeu_ps(reinterpret_cast<float*>(v), ret);
-}
-
-const __m128i pass1_shf = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
-const __m128i pass1_add = _mm_setr_epi8(1, 1, 3, 3, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
-const __m128i pass2_shf = _mm_setr_epi8(2, 4, 0, 5, 1, 3, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
-const __m128i pass2_and = _mm_setr_epi8(-2, -3, -2, -2, -3, -2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
-const __m128i pass2_add = _mm_setr_epi8(2, 4, 2, 5, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
-const __m128i pass4_shf = _mm_setr_epi8(0, 2, 1, 4, 3, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
-const __m128i pass4_add = _mm_setr_epi8(0, 2, 2, 4, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
-const __m128i pass5_shf = _mm_setr_epi8(0, 1, 3, 2, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
-const __m128i pass5_add = _mm_setr_epi8(0, 1, 3, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
-void simdsort6(char* __restrict v) {
-	__m128i b, a = _mm_cvtsi32_si128(*reinterpret_cast<const int*>(v));
-	a = _mm_insert_epi16(a, *reinterpret_cast<const int*>(v + 4), 2);
-
-	b = _mm_shuffle_epi8(a, pass1_shf);
-	b = _mm_cmpgt_epi8(b, a);
-	b = _mm_add_epi8(b, pass1_add);
-	a = _mm_shuffle_epi8(a, b);
-
-	b = _mm_shuffle_epi8(a, pass2_shf);
-	b = _mm_cmpgt_epi8(b, a);
-	b = _mm_and_si128(b, pass2_and);
-	b = _mm_add_epi8(b, pass2_add);
-	a = _mm_shuffle_epi8(a, b);
-
-	b = _mm_shuffle_epi8(a, pass1_shf);
-	b = _mm_cmpgt_epi8(b, a);
-	b = _mm_add_epi8(b, pass1_add);
-	a = _mm_shuffle_epi8(a, b);
-
-	b = _mm_shuffle_epi8(a, pass4_shf);
-	b = _mm_cmpgt_epi8(b, a);
-	b = _mm_add_epi8(b, pass4_add);
-	a = _mm_shuffle_epi8(a, b);
-
-	b = _mm_shuffle_epi8(a, pass5_shf);
-	b = _mm_cmpgt_epi8(b, a);
-	b = _mm_add_epi8(b, pass5_add);
-	a = _mm_shuffle_epi8(a, b);
-
-	*reinterpret_cast<int*>(v) = _mm_cvtsi128_si32(a);
-	*reinterpret_cast<int16_t*>(v + 4) = _mm_extract_epi16(a, 2);
-}
-
-
-// works but very slow compared to scalar version because
-// of repeated inter-lane (3 cycle latency)
-
-//const __m256i pass1_shfi = _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 6, 7);
-//const __m256i pass1_addi = _mm256_setr_epi32(1, 1, 3, 3, 5, 5, 6, 7);
-//const __m256i pass2_shfi = _mm256_setr_epi32(2, 4, 0, 5, 1, 3, 6, 7);
-//const __m256i pass2_andi = _mm256_setr_epi32(-2, -3, -2, -2, -3, -2, 0, 0);
-//const __m256i pass2_addi = _mm256_setr_epi32(2, 4, 2, 5, 4, 5, 6, 7);
-//const __m256i pass4_shfi = _mm256_setr_epi32(0, 2, 1, 4, 3, 5, 6, 7);
-//const __m256i pass4_addi = _mm256_setr_epi32(0, 2, 2, 4, 4, 5, 6, 7);
-//const __m256i pass5_shfi = _mm256_setr_epi32(0, 1, 3, 2, 4, 5, 6, 7);
-//const __m256i pass5_addi = _mm256_setr_epi32(0, 1, 3, 3, 4, 5, 6, 7);
-//void simdsort6(int* __restrict v) {
-//	__m256i b, a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v));
-//	
-//	b = _mm256_permutevar8x32_epi32(a, pass1_shfi);
-//	b = _mm256_cmpgt_epi32(b, a);
-//	b = _mm256_add_epi32(b, pass1_addi);
-//	a = _mm256_permutevar8x32_epi32(a, b);
-//
-//	b = _mm256_permutevar8x32_epi32(a, pass2_shfi);
-//	b = _mm256_cmpgt_epi32(b, a);
-//	b = _mm256_and_si256(b, pass2_andi);
-//	b = _mm256_add_epi32(b, pass2_addi);
-//	a = _mm256_permutevar8x32_epi32(a, b);
-//
-//	b = _mm256_permutevar8x32_epi32(a, pass1_shfi);
-//	b = _mm256_cmpgt_epi32(b, a);
-//	b = _mm256_add_epi32(b, pass1_addi);
-//	a = _mm256_permutevar8x32_epi32(a, b);
-//
-//	b = _mm256_permutevar8x32_epi32(a, pass4_shfi);
-//	b = _mm256_cmpgt_epi32(b, a);
-//	b = _mm256_add_epi32(b, pass4_addi);
-//	a = _mm256_permutevar8x32_epi32(a, b);
-//
-//	b = _mm256_permutevar8x32_epi32(a, pass5_shfi);
-//	b = _mm256_cmpgt_epi32(b, a);
-//	b = _mm256_add_epi32(b, pass5_addi);
-//	a = _mm256_permutevar8x32_epi32(a, b);
-//
-//	_mm_storeu_si128((__m128i*)v, _mm256_castsi256_si128(a));
-//	*reinterpret_cast<long long*>(v + 4) = _mm_cvtsi128_si64(_mm256_extracti128_si256(a, 1));
-//}
\ No newline at end of file
+/*******************************************************************
+*   sorts.cpp
+*   Sorting Networks
+*
+*	Author: Kareem Omar
+*	kareem.omar@uah.edu
+*	https://github.com/komrad36
+*
+*	Last updated Feb 15, 2017
+*******************************************************************/
+//
+// SUMMARY: I present novel and state-of-the-art sorting of 4 int32_t
+// and sorting of 6 int8_t, as examples, using SSE4, and some thoughts
+// and notes on fast sorting of small fixed-size arrays.
+//
+// These are the fastest known approaches on modern CPUs.
+// They are completely branchless and extremely fast.
+// For example, 4 int32_t can be sorted in ~18 cycles on Skylake.
+//
+// These examples can be modified to sort signed or unsigned data as long
+// as the total size of the data is <= 128 bits (16 bytes). Note that
+// trying to use AVX2 to push that to 256 bits will NOT HELP
+// because of the 3 cycle interlane latency that makes shuffling
+// across the 128-bit lane boundary too expensive to be useful.
+//
+// In that case, or in the case that you can't support SSE4,
+// efficient scalar code can also be generated that isn't too much
+// slower, but it's not immediately evident what the optimal approach
+// is in assembly, nor how to coerce C/C++ compilers to produce that
+// assembly from C/C++ code. (I discuss the approach at the end of this
+// documentation.)
+//
+// Not all compilers correctly generate optimal assembly for either the
+// SSE or scalar code, so I provide assembly versions too. In fact, this
+// is not a strong enough statement; many compilers FAIL MISERABLY
+// at both the SSE and scalar cases for n >= 3. CL in particular
+// (Microsoft Visual C++) just dies horribly in a fire, so the assembly
+// snippets may not be a bad idea. Profile and/or check your disassembly.
+//
+// Note that these assembly snippets use the Windows x64 calling convention,
+// but then proceed to clobber a bunch of registers they shouldn't. Normally
+// they'd be inlined. Feel free to callee-save registers that your
+// application cannot safely clobber.
+//
+// These code snippets work on the principle of sorting networks.
+// Conventional sorting algorithms like quicksort and mergesort
+// are not great at small array sizes. One notices in profiling that
+// simpler sorts like insertion and selection tend to win. However,
+// even these are not NEARLY as fast as they could be for
+// fixed-size, small arrays.
+//
+// Available sorts and their function names:
+//
+// >>> SSE Assembly (fast as hell. FASTEST option on modern CPUs.
+//					 these are written in MASM for Win64;
+//					 but it's Intel syntax and you can make the small
+//					 modifications required for other assemblers.)
+// Sorting 4 int32_t  |  simdsort4a()
+// Sorting 4 int32_t  |  simdsort4a_noconstants()
+// Sorting 4 int32_t  |  simdsort4a_nofloat()
+//
+// >>> SSE C++ (make sure generated assembly matches):
+// Sorting 4 int32_t  |  simdsort4()
+// Sorting 4 int32_t, in-register  |  simdsort4_reg()
+// Sorting 4 int32_t  |  simdsort4_nofloat()
+// Sorting 4 int32_t, no constants  |  simdsort4_noconstants()
+// Sorting 6 int8_t   |  simdsort6()
+// Sorting 6 int8_t, no constants   |  simdsort6_noconstants()
+// Sorting 6 int8_t, stable   |  simdsort6_stable()
+// Sorting 6 int8_t, in-register   |  simdsort6_reg()
+// Merging sorted 4+4 int32_t, in-register  |  simdmerge4x2()
+// Sorting 8 int32_t   |  simdsort8()
+// Sorting 16 int32_t  |  simdsort16()
+// Sorting 8 int16_t   |  simdsort8_epi16()
+// Sorting 4 int16_t   |  simdsort4_epi16()
+// Sorting 2 int64_t   |  simdsort2_epi64()
+// Sorting 4 int64_t   |  simdsort4_epi64()
+// Sorting 2 double    |  simdsort2d()
+// Sorting 4 double    |  simdsort4d()
+// Sorting n <= 16 int32_t, runtime n  |  sort_small()
+// Sorting many 4 int32_t  |  simdsort4_batch()
+// Sorting many 4 int32_t, non-temporal  |  simdsort4_batch_stream()
+// Sorting many 4 int32_t, multithreaded  |  simdsort4_batch_parallel()
+// Sorting many 4 int32_t, column layout  |  simdsort4_soa()  (+ AoS<->SoA converters)
+// Sorting many 4 int32_t, indexed (gather)  |  simdsort4_gather()
+// Sorting many 6 int8_t   |  simdsort6_batch()
+// Median pair of 4 int32_t  |  median4()
+// Top two of 4 int32_t       |  max2of4()
+// Ranks (sort permutation) of 4 int32_t  |  rank4()
+// Sort + dedupe 4 int32_t  |  sort_unique4()
+// Sort + dedupe 6 int8_t   |  sort_unique6()
+// Sorting 4 uint32_t  |  simdsort4u()
+// Sorting 4 float     |  simdsort4f()
+// Sorting 6 uint8_t   |  simdsort6u()
+// Sorting 4 int32_t + payload  |  simdsort4kv()
+// Sorting 6 int8_t + payload   |  simdsort6kv()
+// Sorting N of int8/16/32, generated  |  netsort<N, T>()  (netsort.h)
+// Sliding median filter, window N  |  MedianFilter<N>  (medianfilter.h)
+//
+// >>> AVX2 C++ (vertical/column-wise; requires __AVX2__):
+// Sorting 8x 4 int32_t  |  simdsort4x8()
+//
+// >>> AVX-512 C++ (vertical/column-wise batch paths; selected at build
+//					time inside simdsort4_batch / simdsort6_batch)
+//
+// >>> Runtime dispatch (dispatch.cpp; CPUID-resolved once at startup)
+// Best kernel for this CPU  |  simdsort4_best / simdsort6_best /
+//                              simdsort4_batch_best / simdsort6_batch_best
+//
+// >>> Scalar Assembly (these are written in MASM for Win64;
+//						but it's Intel syntax and you can make the small
+//						modifications required for other assemblers.)
+// Sorting 2 int32_t  |  sort2a()
+// Sorting 3 int32_t  |  sort3a()
+// Sorting 4 int32_t  |  sort4a()
+// Sorting 5 int32_t  |  sort5a()
+// Sorting 6 int32_t  |  sort6a()
+// Sorting 8 int32_t  |  sort8a()
+// Sorting 16 int32_t |  sort16a()
+// Sorting 4 int64_t  |  sort4a64()
+// (System V / ELF ports of all the assembly kernels, for gas, are in
+//  sorts_sysv.S - same names, link it directly on Linux.)
+//
+// >>> Scalar C++ (make sure generated assembly matches)
+// Sorting 2 int32_t  |  sort2()
+// Sorting 6 int32_t  |  sort6()
+// Sorting 6 int32_t, stable  |  sort6_stable()
+// Sorting 6 int32_t + payload  |  sort6kv()
+// Sorting 4 int64_t  |  sort4_epi64()
+// Median of 5 int32_t  |  median5()
+// Sorting N (2-16) of any T  |  sortN<N, T>()
+//
+//
+// Okay, if you've made it this far, let's discuss
+// fast conditional swap operations.Conditional swaps
+// if the lower element is greater are the heart of sorting
+// networks.Given two values,
+// 'a', and 'b', leave them as they are if 'a' is less
+// than 'b', i.e. if they are in sorted order.However,
+// swap them if 'a' is greater than or equal to 'b'.
+// Thus after such a conditional swap operation 'a' and 'b' are in sorted
+// order no matter what order they came in as.
+//
+// A series of such operations can deterministically sort
+// a fixed - size array. Typically one can optimize for depth
+// (minimum number of operations given infinite parallel
+// processing) or for size (minimum number of operations given
+// no parallel processing). For n == 4 these two optimal solutions
+// are actually given by the same network, with depth 3 and
+// size 5.
+//
+// Scalar first : how do you efficiently conditional swap ? Again, note that
+// lots of compilers don't produce optimal assembly no matter
+// what C++ you give them.But what is the optimal assembly ?
+// Well, on modern processors, the answer is conditional moves :
+//
+// ; inputs: eax, r9d
+// ; scratch register: edx
+//	cmp     eax, r9d
+//	mov     edx, eax
+//	cmovg   eax, r9d
+//	cmovg   r9d, edx
+// ; eax and r9d have been swapped if necessary such that eax is now <= r9d
+//
+// See the function 'sort6' in 'sorts.cpp' for an attempt at some C++ code
+// that has a decent chance of compiling into conditional swaps that look like that.
+// Again, they OFTEN DON'T, especially the CL compiler and g++. Use the assembly
+// snippets instead, or at least profile and inspect your disassembly to be sure.
+//
+// The SSE sorts are rather more sophisticated, but the basic principle
+// is to branchlessly generate shuffle index masks at runtime and then
+// use them to permute the order of the data in parallel, performing
+// one complete level of the sorting network at a time.
+//
+// I provide 3 versions of the assembly for sorting 4 int32_t. The fastest
+// should be the plain 'simdsort4a'. It performs float reinterpretation
+// and relies on some constant loads, but both of these are USUALLY
+// better than the alternatives. However:
+//
+// Older CPUs may incur too much latency from the reinterpretation to be
+// worth it. For such CPUs, try 'simdsort4a_nofloat.asm'.
+//
+// Applications that cannot afford to have these constants occupying L1
+// may wish to try 'simdsort4a_noconstants.asm', which does not eat
+// up any cache space with constants - everything is done with immediates
+// and some fairly nasty bit twiddling.
+//
+
+#include "sorts.h"
+#include "profile.h"
+
+#include <cstring>
+
+void sort2(int* __restrict v) {
+	SIMDSORT_PROF(sort2);
+	const int a = v[0];
+	const int b = v[1];
+	v[0] = b > a ? a : b;
+	v[1] = b > a ? b : a;
+}
+
+void sort6(int* __restrict v) {
+	SIMDSORT_PROF(sort6);
+#define __kmin(a, b) (a < b ? a : b)
+#define __kmax(a, b) (a < b ? b : a)
+#define __kswap(x,y) { int a = __kmin(v[x], v[y]); int b = __kmax(v[x], v[y]); v[x] = a; v[y] = b; }
+	__kswap(1, 2);
+	__kswap(0, 2);
+	__kswap(0, 1);
+	__kswap(4, 5);
+	__kswap(3, 5);
+	__kswap(3, 4);
+	__kswap(0, 3);
+	__kswap(1, 4);
+	__kswap(2, 5);
+	__kswap(2, 4);
+	__kswap(1, 3);
+	__kswap(2, 3);
+#undef __kswap
+#undef __kmax
+#undef __kmin
+}
+
+void sort6(const int* __restrict in, int* __restrict out) {
+	int v[6] = { in[0], in[1], in[2], in[3], in[4], in[5] };
+#define __kmin(a, b) (a < b ? a : b)
+#define __kmax(a, b) (a < b ? b : a)
+#define __kswap(x,y) { int a = __kmin(v[x], v[y]); int b = __kmax(v[x], v[y]); v[x] = a; v[y] = b; }
+	__kswap(1, 2);
+	__kswap(0, 2);
+	__kswap(0, 1);
+	__kswap(4, 5);
+	__kswap(3, 5);
+	__kswap(3, 4);
+	__kswap(0, 3);
+	__kswap(1, 4);
+	__kswap(2, 5);
+	__kswap(2, 4);
+	__kswap(1, 3);
+	__kswap(2, 3);
+#undef __kswap
+#undef __kmax
+#undef __kmin
+	out[0] = v[0]; out[1] = v[1]; out[2] = v[2];
+	out[3] = v[3]; out[4] = v[4]; out[5] = v[5];
+}
+
+// stable variant of sort6. The 12-comparator network above is optimal
+// but not stable: a comparator like (2,5) can carry an element past
+// an equal one sitting at 3 or 4 without ever comparing against it.
+// Ruling that out means adjacent comparators only - two equal
+// elements then can't change relative order, because the only way
+// past each other is a compare-exchange between them, and ?: min/max
+// never swaps an equal pair. Adjacent-only and 6 elements means
+// odd-even transposition: 15 comparators in 6 alternating bricks,
+// 3 comparators more than sort6 pays for the guarantee. For bare
+// ints stability is invisible, of course; this network is the one to
+// lift to key+payload swaps (sort6kv-style) when tie order matters.
+void sort6_stable(int* __restrict v) {
+#define __kmin(a, b) (a < b ? a : b)
+#define __kmax(a, b) (a < b ? b : a)
+#define __kswap(x,y) { int a = __kmin(v[x], v[y]); int b = __kmax(v[x], v[y]); v[x] = a; v[y] = b; }
+	__kswap(0, 1);
+	__kswap(2, 3);
+	__kswap(4, 5);
+	__kswap(1, 2);
+	__kswap(3, 4);
+	__kswap(0, 1);
+	__kswap(2, 3);
+	__kswap(4, 5);
+	__kswap(1, 2);
+	__kswap(3, 4);
+	__kswap(0, 1);
+	__kswap(2, 3);
+	__kswap(4, 5);
+	__kswap(1, 2);
+	__kswap(3, 4);
+#undef __kswap
+#undef __kmax
+#undef __kmin
+}
+
+// this is the 'no float' version - same network, but byte shuffles
+// (pshufb) instead of permutevar, so the data never crosses into the
+// float domain and nothing past SSE4 is required. On CPUs where the
+// int->float bypass latency hurts (or where AVX is absent entirely)
+// this wins; simdsort4_best in dispatch.cpp binds it when appropriate
+const __m128i pass1_add4s = _mm_setr_epi8(4, 5, 6, 7, 4, 5, 6, 7, 12, 13, 14, 15, 12, 13, 14, 15);
+const __m128i pass2_add4s = _mm_setr_epi8(8, 9, 10, 11, 12, 13, 14, 15, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i pass3_add4s = _mm_setr_epi8(0, 1, 2, 3, 8, 9, 10, 11, 8, 9, 10, 11, 12, 13, 14, 15);
+void simdsort4_nofloat(int* __restrict v) {
+	__m128i b, a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+
+	b = _mm_shuffle_epi32(a, 177);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_and_si128(b, _mm_set1_epi8(-4));
+	b = _mm_add_epi8(b, pass1_add4s);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi32(a, 78);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_and_si128(b, _mm_set1_epi8(-8));
+	b = _mm_add_epi8(b, pass2_add4s);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi32(a, 216);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_and_si128(b, _mm_set1_epi8(-4));
+	b = _mm_add_epi8(b, pass3_add4s);
+	a = _mm_shuffle_epi8(a, b);
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), a);
+}
+
+// this is the 'no constants' version as first-class C++ - the same
+// bit twiddling simdsort4a_noconstants.asm does, so the kernel owns
+// ZERO data-cache lines. Every mask is an immediate baked into the
+// instruction stream: pass 1 gets its whole-pair verdict from a
+// 64-bit compare (the qword compare of (a1,a0,a3,a2) against
+// (a0,a1,a2,a3) broadcasts "high dword wins" across each pair for
+// free), and passes 2 and 3 broadcast the deciding lane of the dword
+// compare with pshufd immediates, feeding blendv instead of the
+// shuffle-mask adds. Slower than simdsort4 when the constants are
+// resident, faster when every call would miss on them - i.e. cold
+// call sites between large scans that flush L1.
+void simdsort4_noconstants(int* __restrict v) {
+	__m128i b, m, a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+
+	b = _mm_shuffle_epi32(a, 177);
+	m = _mm_cmpgt_epi64(b, a);
+	a = _mm_blendv_epi8(a, b, m);
+
+	b = _mm_shuffle_epi32(a, 78);
+	m = _mm_cmpgt_epi32(b, a);
+	m = _mm_shuffle_epi32(m, 238);
+	a = _mm_blendv_epi8(a, b, m);
+
+	b = _mm_shuffle_epi32(a, 216);
+	m = _mm_cmpgt_epi32(b, a);
+	m = _mm_shuffle_epi32(m, 232);
+	a = _mm_blendv_epi8(a, b, m);
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), a);
+}
+
+// this is the version that should be the fastest
+const __m128i pass1_add4 = _mm_setr_epi32(1, 1, 3, 3);
+const __m128i pass2_add4 = _mm_setr_epi32(2, 3, 2, 3);
+const __m128i pass3_add4 = _mm_setr_epi32(0, 2, 2, 3);
+
+// register-to-register core: when the 4 values already live in an
+// xmm register there is no reason to round-trip them through memory
+// just to call the pointer version - the argument arrives in xmm0 and
+// the result leaves in xmm0. The pointer versions below are wrappers
+__m128i simdsort4_reg(__m128i a) {
+	__m128i b;
+
+	b = _mm_shuffle_epi32(a, 177);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_add_epi32(b, pass1_add4);
+	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+
+	b = _mm_shuffle_epi32(a, 78);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_add_epi32(b, b);
+	b = _mm_add_epi32(b, pass2_add4);
+	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+
+	b = _mm_shuffle_epi32(a, 216);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_add_epi32(b, pass3_add4);
+	return _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+}
+
+void simdsort4(int* __restrict v) {
+	SIMDSORT_PROF(simdsort4);
+	const __m128i a = simdsort4_reg(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v)));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), a);
+}
+
+#ifdef __AVX512F__
+// AVX-512 batch path: 16 arrays per pass in the vertical formulation
+// (same idea as simdsort4x8 but with zmm registers), with mask registers
+// covering the tail so a count that isn't a multiple of 16 needs no
+// scalar cleanup - unused lanes load as zero, sort harmlessly, and are
+// never stored back.
+static void simdsort4x16_masked(int* __restrict v, const __mmask16 m0, const __mmask16 m1, const __mmask16 m2, const __mmask16 m3) {
+	const __m512i r0 = _mm512_maskz_loadu_epi32(m0, v);
+	const __m512i r1 = _mm512_maskz_loadu_epi32(m1, v + 16);
+	const __m512i r2 = _mm512_maskz_loadu_epi32(m2, v + 32);
+	const __m512i r3 = _mm512_maskz_loadu_epi32(m3, v + 48);
+
+	const __m512i t0 = _mm512_unpacklo_epi32(r0, r1);
+	const __m512i t1 = _mm512_unpackhi_epi32(r0, r1);
+	const __m512i t2 = _mm512_unpacklo_epi32(r2, r3);
+	const __m512i t3 = _mm512_unpackhi_epi32(r2, r3);
+	__m512i c0 = _mm512_unpacklo_epi64(t0, t2);
+	__m512i c1 = _mm512_unpackhi_epi64(t0, t2);
+	__m512i c2 = _mm512_unpacklo_epi64(t1, t3);
+	__m512i c3 = _mm512_unpackhi_epi64(t1, t3);
+
+#define __kvswap(x, y) { const __m512i lo = _mm512_min_epi32(x, y); const __m512i hi = _mm512_max_epi32(x, y); x = lo; y = hi; }
+	__kvswap(c0, c1);
+	__kvswap(c2, c3);
+	__kvswap(c0, c2);
+	__kvswap(c1, c3);
+	__kvswap(c1, c2);
+#undef __kvswap
+
+	const __m512i u0 = _mm512_unpacklo_epi32(c0, c1);
+	const __m512i u1 = _mm512_unpackhi_epi32(c0, c1);
+	const __m512i u2 = _mm512_unpacklo_epi32(c2, c3);
+	const __m512i u3 = _mm512_unpackhi_epi32(c2, c3);
+
+	_mm512_mask_storeu_epi32(v, m0, _mm512_unpacklo_epi64(u0, u2));
+	_mm512_mask_storeu_epi32(v + 16, m1, _mm512_unpackhi_epi64(u0, u2));
+	_mm512_mask_storeu_epi32(v + 32, m2, _mm512_unpacklo_epi64(u1, u3));
+	_mm512_mask_storeu_epi32(v + 48, m3, _mm512_unpackhi_epi64(u1, u3));
+}
+
+void simdsort4_batch(int* __restrict v, size_t count) {
+	SIMDSORT_PROF(simdsort4_batch);
+	for (; count >= 16; count -= 16, v += 64)
+		simdsort4x16_masked(v, 0xFFFF, 0xFFFF, 0xFFFF, 0xFFFF);
+	if (count) {
+		// 4*count valid lanes, 4 <= lanes <= 60
+		const uint64_t m = (1ULL << (4 * count)) - 1;
+		simdsort4x16_masked(v, static_cast<__mmask16>(m), static_cast<__mmask16>(m >> 16),
+			static_cast<__mmask16>(m >> 32), static_cast<__mmask16>(m >> 48));
+	}
+}
+#else
+// batch version: two arrays in flight at once. The three passes of each
+// array are the same as simdsort4 above, but interleaved so that while
+// one array waits on its _mm_permutevar_ps the other's _mm_cmpgt_epi32
+// and adds can issue. The tail (odd count) falls through to simdsort4.
+void simdsort4_batch(int* __restrict v, size_t count) {
+	SIMDSORT_PROF(simdsort4_batch);
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2, v += 8) {
+		__m128i b0, a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+		__m128i b1, a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + 4));
+
+		b0 = _mm_shuffle_epi32(a0, 177);
+		b1 = _mm_shuffle_epi32(a1, 177);
+		b0 = _mm_cmpgt_epi32(b0, a0);
+		b1 = _mm_cmpgt_epi32(b1, a1);
+		b0 = _mm_add_epi32(b0, pass1_add4);
+		b1 = _mm_add_epi32(b1, pass1_add4);
+		a0 = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a0), b0));
+		a1 = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a1), b1));
+
+		b0 = _mm_shuffle_epi32(a0, 78);
+		b1 = _mm_shuffle_epi32(a1, 78);
+		b0 = _mm_cmpgt_epi32(b0, a0);
+		b1 = _mm_cmpgt_epi32(b1, a1);
+		b0 = _mm_add_epi32(b0, b0);
+		b1 = _mm_add_epi32(b1, b1);
+		b0 = _mm_add_epi32(b0, pass2_add4);
+		b1 = _mm_add_epi32(b1, pass2_add4);
+		a0 = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a0), b0));
+		a1 = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a1), b1));
+
+		b0 = _mm_shuffle_epi32(a0, 216);
+		b1 = _mm_shuffle_epi32(a1, 216);
+		b0 = _mm_cmpgt_epi32(b0, a0);
+		b1 = _mm_cmpgt_epi32(b1, a1);
+		b0 = _mm_add_epi32(b0, pass3_add4);
+		b1 = _mm_add_epi32(b1, pass3_add4);
+		__m128 r0 = _mm_permutevar_ps(_mm_castsi128_ps(a0), b0);
+		__m128 r1 = _mm_permutevar_ps(_mm_castsi128_ps(a1), b1);
+
+		_mm_storeu_ps(reinterpret_cast<float*>(v), r0);
+		_mm_storeu_ps(reinterpret_cast<float*>(v + 4), r1);
+	}
+	if (i < count) simdsort4(v);
+}
+#endif
+
+// streaming version of the batch sort, for batches far beyond LLC
+// (think hundreds of millions of records). The cached version above
+// is the right call when the results are consumed soon; when they are
+// not, every regular store costs a read-for-ownership of a line we
+// are about to fully overwrite and the evicted results pollute the
+// cache on the way out. Here the passes are identical but results
+// leave through non-temporal stores (write-combining, no RFO, no
+// cache fill) and the read side prefetches a few lines ahead so the
+// loads don't stall on DRAM. On a bandwidth-bound batch this is worth
+// roughly a third of the memory traffic.
+//
+// Two things to know:
+//   - 'v' should be 16-byte aligned. Non-temporal stores require it,
+//     so a misaligned base quietly runs the cached version instead.
+//   - the trailing sfence makes the streamed results globally visible
+//     before return, so callers can hand the buffer to another thread
+//     as usual.
+void simdsort4_batch_stream(int* __restrict v, size_t count) {
+	if (reinterpret_cast<uintptr_t>(v) & 15) {
+		simdsort4_batch(v, count);
+		return;
+	}
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2, v += 8) {
+		// 4 lines ahead; consecutive 16-byte NT stores below combine
+		// into full-line writes in the WC buffers
+		_mm_prefetch(reinterpret_cast<const char*>(v + 64), _MM_HINT_NTA);
+
+		__m128i b0, a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+		__m128i b1, a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + 4));
+
+		b0 = _mm_shuffle_epi32(a0, 177);
+		b1 = _mm_shuffle_epi32(a1, 177);
+		b0 = _mm_cmpgt_epi32(b0, a0);
+		b1 = _mm_cmpgt_epi32(b1, a1);
+		b0 = _mm_add_epi32(b0, pass1_add4);
+		b1 = _mm_add_epi32(b1, pass1_add4);
+		a0 = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a0), b0));
+		a1 = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a1), b1));
+
+		b0 = _mm_shuffle_epi32(a0, 78);
+		b1 = _mm_shuffle_epi32(a1, 78);
+		b0 = _mm_cmpgt_epi32(b0, a0);
+		b1 = _mm_cmpgt_epi32(b1, a1);
+		b0 = _mm_add_epi32(b0, b0);
+		b1 = _mm_add_epi32(b1, b1);
+		b0 = _mm_add_epi32(b0, pass2_add4);
+		b1 = _mm_add_epi32(b1, pass2_add4);
+		a0 = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a0), b0));
+		a1 = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a1), b1));
+
+		b0 = _mm_shuffle_epi32(a0, 216);
+		b1 = _mm_shuffle_epi32(a1, 216);
+		b0 = _mm_cmpgt_epi32(b0, a0);
+		b1 = _mm_cmpgt_epi32(b1, a1);
+		b0 = _mm_add_epi32(b0, pass3_add4);
+		b1 = _mm_add_epi32(b1, pass3_add4);
+		__m128 r0 = _mm_permutevar_ps(_mm_castsi128_ps(a0), b0);
+		__m128 r1 = _mm_permutevar_ps(_mm_castsi128_ps(a1), b1);
+
+		_mm_stream_ps(reinterpret_cast<float*>(v), r0);
+		_mm_stream_ps(reinterpret_cast<float*>(v + 4), r1);
+	}
+	if (i < count) simdsort4(v);
+	_mm_sfence();
+}
+
+// out-of-place overloads: identical networks, but the sorted result
+// goes to a separate destination instead of back over the input. In a
+// streaming pipeline this breaks the store-to-load dependency between
+// the sort's store and the consumer's load of the same address, and
+// with inlining the compiler can keep the result in a register or
+// write it straight into the destination ring buffer.
+void simdsort4(const int* __restrict in, int* __restrict out) {
+	const __m128i a = simdsort4_reg(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in)));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(out), a);
+}
+
+// pruned partial-sort kernels: when only part of the sorted output is
+// live, whole comparators of the network are dead and can be dropped.
+// These are the three cases our users actually hit.
+
+// the two middle elements of 4 (out[0] <= out[1]). The middles of a
+// sorted 4 are exactly { max of the pair minima, min of the pair
+// maxima }, which takes 3 min/max levels and no shuffle-mask passes.
+void median4(const int* __restrict v, int* __restrict out) {
+	const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+	const __m128i b = _mm_shuffle_epi32(a, 177);
+	const __m128i lo = _mm_min_epi32(a, b);
+	const __m128i hi = _mm_max_epi32(a, b);
+	const __m128i ml = _mm_max_epi32(lo, _mm_shuffle_epi32(lo, 78));
+	const __m128i mh = _mm_min_epi32(hi, _mm_shuffle_epi32(hi, 78));
+	out[0] = _mm_cvtsi128_si32(_mm_min_epi32(ml, mh));
+	out[1] = _mm_cvtsi128_si32(_mm_max_epi32(ml, mh));
+}
+
+// the two largest of 4 (out[0] = second largest, out[1] = largest).
+void max2of4(const int* __restrict v, int* __restrict out) {
+	const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+	const __m128i b = _mm_shuffle_epi32(a, 177);
+	const __m128i lo = _mm_min_epi32(a, b);
+	const __m128i hi = _mm_max_epi32(a, b);
+	const __m128i hs = _mm_shuffle_epi32(hi, 78);
+	const __m128i second = _mm_max_epi32(_mm_min_epi32(hi, hs), _mm_max_epi32(lo, _mm_shuffle_epi32(lo, 78)));
+	out[0] = _mm_cvtsi128_si32(second);
+	out[1] = _mm_cvtsi128_si32(_mm_max_epi32(hi, hs));
+}
+
+// the sort permutation without the sort: lane i of the result holds
+// the rank of v[i], i.e. how many elements precede it in sorted
+// order. Each rank is just a popcount of "smaller than me" verdicts,
+// so three rotations of the register visit every ordered pair and
+// the ranks accumulate as compare-mask subtractions - no shuffle-mask
+// passes, no permute, shorter than the full sort. Ties break by
+// index (a later duplicate outranks an earlier one, via cmpeq gated
+// on the constant index-order masks), so the result is always a
+// permutation of {0,1,2,3} and can be inverted or used to scatter
+// payloads directly.
+__m128i rank4_reg(__m128i a) {
+	const __m128i r1 = _mm_shuffle_epi32(a, 57);
+	const __m128i r2 = _mm_shuffle_epi32(a, 78);
+	const __m128i r3 = _mm_shuffle_epi32(a, 147);
+	__m128i r = _mm_setzero_si128();
+	r = _mm_sub_epi32(r, _mm_or_si128(_mm_cmpgt_epi32(a, r1), _mm_and_si128(_mm_cmpeq_epi32(a, r1), _mm_setr_epi32(0, 0, 0, -1))));
+	r = _mm_sub_epi32(r, _mm_or_si128(_mm_cmpgt_epi32(a, r2), _mm_and_si128(_mm_cmpeq_epi32(a, r2), _mm_setr_epi32(0, 0, -1, -1))));
+	r = _mm_sub_epi32(r, _mm_or_si128(_mm_cmpgt_epi32(a, r3), _mm_and_si128(_mm_cmpeq_epi32(a, r3), _mm_setr_epi32(0, -1, -1, -1))));
+	return r;
+}
+
+// nibble-packed convenience wrapper: the rank of v[i] sits in bits
+// [4i, 4i+4) of the return value
+int rank4(const int* __restrict v) {
+	const __m128i r = rank4_reg(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v)));
+	return _mm_cvtsi128_si32(r) | _mm_extract_epi32(r, 1) << 4 | _mm_extract_epi32(r, 2) << 8 | _mm_extract_epi32(r, 3) << 12;
+}
+
+// fused sort + deduplicate: sort, then compact duplicates away before
+// the result ever leaves the register, so callers that would follow
+// the sort with a scalar duplicate scan (set intersections, posting
+// lists) get both for barely more than the sort alone. Once the data
+// is sorted, equal elements are adjacent, so one compare against the
+// element-shifted register flags every duplicate; the movemask of
+// that verdict indexes a table of compaction shuffles (and a parallel
+// count table, so no popcount dependency). Lanes past the distinct
+// count come back holding copies of the largest distinct value.
+static const __m128i unique4_shf[8] = {
+	_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 2, 3, 8, 9, 10, 11, 12, 13, 14, 15, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 12, 13, 14, 15, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 2, 3, 12, 13, 14, 15, 12, 13, 14, 15, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 8, 9, 10, 11),
+	_mm_setr_epi8(0, 1, 2, 3, 8, 9, 10, 11, 8, 9, 10, 11, 8, 9, 10, 11),
+	_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 4, 5, 6, 7, 4, 5, 6, 7),
+	_mm_setr_epi8(0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3),
+};
+static const uint8_t unique4_cnt[8] = { 4, 3, 3, 2, 3, 2, 2, 1 };
+
+int sort_unique4(int* __restrict v) {
+	__m128i a = simdsort4_reg(_mm_loadu_si128(reinterpret_cast<const __m128i*>(v)));
+	const __m128i e = _mm_cmpeq_epi32(a, _mm_slli_si128(a, 4));
+	// bit 0 compares lane 0 against the shifted-in zero; drop it
+	const int d = _mm_movemask_ps(_mm_castsi128_ps(e)) >> 1;
+	a = _mm_shuffle_epi8(a, unique4_shf[d]);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), a);
+	return unique4_cnt[d];
+}
+
+// 6-element sibling on the simdsort6 path: same scheme at byte
+// granularity, 5 meaningful duplicate bits so a 32-entry table
+static const __m128i unique6_shf[32] = {
+	_mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 2, 3, 4, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 3, 4, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 3, 4, 5, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 2, 4, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 2, 4, 5, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 4, 5, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 4, 5, 5, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 2, 3, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 2, 3, 5, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 3, 5, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 3, 5, 5, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 2, 5, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 2, 5, 5, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 5, 5, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 5, 5, 5, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 2, 3, 4, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 2, 3, 4, 4, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 3, 4, 4, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 3, 4, 4, 4, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 2, 4, 4, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 2, 4, 4, 4, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 4, 4, 4, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 4, 4, 4, 4, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 2, 3, 3, 3, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 2, 3, 3, 3, 3, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 3, 3, 3, 3, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 3, 3, 3, 3, 3, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 2, 2, 2, 2, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 2, 2, 2, 2, 2, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 1, 1, 1, 1, 1, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+	_mm_setr_epi8(0, 0, 0, 0, 0, 0, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15),
+};
+static const uint8_t unique6_cnt[32] = {
+	6, 5, 5, 4, 5, 4, 4, 3, 5, 4, 4, 3, 4, 3, 3, 2,
+	5, 4, 4, 3, 4, 3, 3, 2, 4, 3, 3, 2, 3, 2, 2, 1,
+};
+
+int sort_unique6(char* __restrict v) {
+	__m128i a = _mm_cvtsi32_si128(*reinterpret_cast<const int*>(v));
+	a = _mm_insert_epi16(a, *reinterpret_cast<const int*>(v + 4), 2);
+	a = simdsort6_reg(a);
+	const __m128i e = _mm_cmpeq_epi8(a, _mm_slli_si128(a, 1));
+	const int d = (_mm_movemask_epi8(e) >> 1) & 31;
+	a = _mm_shuffle_epi8(a, unique6_shf[d]);
+	*reinterpret_cast<int*>(v) = _mm_cvtsi128_si32(a);
+	*reinterpret_cast<int16_t*>(v + 4) = _mm_extract_epi16(a, 2);
+	return unique6_cnt[d];
+}
+
+// median of 5, scalar: the classic 6-comparison selection - the
+// median of 5 is the median of { v[4], max of pair minima, min of
+// pair maxima }. Same ternary min/max idiom as sort6, so cooperating
+// compilers emit a short branchless cmov chain.
+int median5(const int* __restrict v) {
+#define __kmin(a, b) (a < b ? a : b)
+#define __kmax(a, b) (a < b ? b : a)
+	const int f = __kmax(__kmin(v[0], v[1]), __kmin(v[2], v[3]));
+	const int g = __kmin(__kmax(v[0], v[1]), __kmax(v[2], v[3]));
+	return __kmax(__kmin(v[4], f), __kmin(__kmax(v[4], f), g));
+#undef __kmax
+#undef __kmin
+}
+
+// unsigned version of the 4-element sort: the shuffle-mask machinery
+// compares with signed _mm_cmpgt_epi32, so bias the values by XORing
+// the sign bit at load and again at store - one extra op each way -
+// which maps uint32 order onto int32 order.
+void simdsort4u(uint32_t* __restrict v) {
+	__m128i b, a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+	const __m128i bias = _mm_set1_epi32(INT32_MIN);
+	a = _mm_xor_si128(a, bias);
+
+	b = _mm_shuffle_epi32(a, 177);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_add_epi32(b, pass1_add4);
+	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+
+	b = _mm_shuffle_epi32(a, 78);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_add_epi32(b, b);
+	b = _mm_add_epi32(b, pass2_add4);
+	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+
+	b = _mm_shuffle_epi32(a, 216);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_add_epi32(b, pass3_add4);
+	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), _mm_xor_si128(a, bias));
+}
+
+// float version of the 4-element sort. Instead of comparing as floats
+// (where any NaN compares false both ways and the shuffle masks stop
+// being permutations, i.e. elements get silently duplicated), the bit
+// patterns are mapped through the classic monotonic float-to-int
+// transform - flip all bits of negatives, just the sign bit of
+// non-negatives - and sorted as int32 with the unmodified passes.
+// NaN policy: this induces a total order, so the output is always a
+// permutation of the input; positive NaNs sort above +inf, negative
+// NaNs below -inf, and -0.0f sorts before 0.0f.
+void simdsort4f(float* __restrict v) {
+	__m128i b, a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+	a = _mm_xor_si128(a, _mm_and_si128(_mm_srai_epi32(a, 31), _mm_set1_epi32(INT32_MAX)));
+
+	b = _mm_shuffle_epi32(a, 177);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_add_epi32(b, pass1_add4);
+	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+
+	b = _mm_shuffle_epi32(a, 78);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_add_epi32(b, b);
+	b = _mm_add_epi32(b, pass2_add4);
+	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+
+	b = _mm_shuffle_epi32(a, 216);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_add_epi32(b, pass3_add4);
+	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+
+	a = _mm_xor_si128(a, _mm_and_si128(_mm_srai_epi32(a, 31), _mm_set1_epi32(INT32_MAX)));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), a);
+}
+
+// key-value version of the 4 int32_t sort: sorts the keys and carries
+// a payload register through the same permutation. The simdsort4 masks
+// cannot be reused directly: they pick each destination's source off
+// its own strict compare, so two equal keys can both select the same
+// source - harmless for keys, fatal for a payload. Here each pass
+// computes one swap predicate per comparator and broadcasts it to both
+// lanes of the pair, so the mask is always a true permutation. Note
+// that a valid permutation is NOT a stable one: equal keys never swap
+// within a comparator, but the (0,2)/(1,3) level can still carry a key
+// past an equal one it never compares against - (0,-1,-1,-1) lands its
+// payloads as B,D,C,A. If tie order matters, break ties by index the
+// way simdsort6kv does (tag the compare operands with lane indices).
+const __m128i kv_idx4 = _mm_setr_epi32(0, 1, 2, 3);
+const __m128i kv_delta1 = _mm_setr_epi32(1, -1, 1, -1);
+const __m128i kv_delta2 = _mm_setr_epi32(2, 2, -2, -2);
+const __m128i kv_delta3 = _mm_setr_epi32(0, 1, -1, 0);
+void simdsort4kv(int* __restrict k, int* __restrict p) {
+	__m128i b, a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(k));
+	__m128 q = _mm_loadu_ps(reinterpret_cast<const float*>(p));
+
+	// comparators (0,1), (2,3)
+	b = _mm_cmpgt_epi32(a, _mm_shuffle_epi32(a, 177));
+	b = _mm_shuffle_epi32(b, 160);
+	b = _mm_add_epi32(_mm_and_si128(b, kv_delta1), kv_idx4);
+	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+	q = _mm_permutevar_ps(q, b);
+
+	// comparators (0,2), (1,3)
+	b = _mm_cmpgt_epi32(a, _mm_shuffle_epi32(a, 78));
+	b = _mm_shuffle_epi32(b, 68);
+	b = _mm_add_epi32(_mm_and_si128(b, kv_delta2), kv_idx4);
+	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+	q = _mm_permutevar_ps(q, b);
+
+	// comparator (1,2)
+	b = _mm_cmpgt_epi32(a, _mm_shuffle_epi32(a, 216));
+	b = _mm_shuffle_epi32(b, 212);
+	b = _mm_add_epi32(_mm_and_si128(b, kv_delta3), kv_idx4);
+	const __m128 ret = _mm_permutevar_ps(_mm_castsi128_ps(a), b);
+	q = _mm_permutevar_ps(q, b);
+
+	_mm_storeu_ps(reinterpret_cast<float*>(k), ret);
+	_mm_storeu_ps(reinterpret_cast<float*>(p), q);
+}
+
+// scalar key-value version of sort6: the payload rides along through
+// every conditional swap. Written in the same ternary style so the
+// key swap and payload swap share one comparison and, with a
+// cooperating compiler, one flags result driving four cmovs.
+void sort6kv(int* __restrict v, int* __restrict p) {
+#define __kswap(x, y) { \
+	const bool s = v[y] < v[x]; \
+	const int a = s ? v[y] : v[x]; const int b = s ? v[x] : v[y]; \
+	const int c = s ? p[y] : p[x]; const int d = s ? p[x] : p[y]; \
+	v[x] = a; v[y] = b; p[x] = c; p[y] = d; }
+	__kswap(1, 2);
+	__kswap(0, 2);
+	__kswap(0, 1);
+	__kswap(4, 5);
+	__kswap(3, 5);
+	__kswap(3, 4);
+	__kswap(0, 3);
+	__kswap(1, 4);
+	__kswap(2, 5);
+	__kswap(2, 4);
+	__kswap(1, 3);
+	__kswap(2, 3);
+#undef __kswap
+}
+
+// sorts the 4 int32_t in one xmm register with the same 3 shuffle
+// passes as simdsort4 - split out so the n = 8 and n = 16 sorts below
+// can run several registers through the passes at once.
+static inline __m128i sort4_reg(__m128i a) {
+	__m128i b;
+
+	b = _mm_shuffle_epi32(a, 177);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_add_epi32(b, pass1_add4);
+	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+
+	b = _mm_shuffle_epi32(a, 78);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_add_epi32(b, b);
+	b = _mm_add_epi32(b, pass2_add4);
+	a = _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+
+	b = _mm_shuffle_epi32(a, 216);
+	b = _mm_cmpgt_epi32(b, a);
+	b = _mm_add_epi32(b, pass3_add4);
+	return _mm_castps_si128(_mm_permutevar_ps(_mm_castsi128_ps(a), b));
+}
+
+// bitonic merge within one register: input is a bitonic sequence of 4,
+// output is sorted. Two vertical min/max stages, recombining with an
+// unpack and a blend rather than runtime shuffle masks since the
+// lane selection here is fixed.
+static inline __m128i bitonic4_reg(__m128i a) {
+	__m128i b = _mm_shuffle_epi32(a, 78);
+	__m128i lo = _mm_min_epi32(a, b);
+	__m128i hi = _mm_max_epi32(a, b);
+	a = _mm_unpacklo_epi64(lo, hi);
+	b = _mm_shuffle_epi32(a, 177);
+	lo = _mm_min_epi32(a, b);
+	hi = _mm_max_epi32(a, b);
+	return _mm_blend_epi16(lo, hi, 0xCC);
+}
+
+// merges two sorted registers of 4 into a sorted sequence of 8 across
+// (a, b): reverse b to make the 8 bitonic, one vertical min/max level,
+// then a bitonic merge of 4 inside each register.
+static inline void bitonic_merge_44(__m128i& a, __m128i& b) {
+	const __m128i r = _mm_shuffle_epi32(b, 27);
+	const __m128i lo = _mm_min_epi32(a, r);
+	const __m128i hi = _mm_max_epi32(a, r);
+	a = bitonic4_reg(lo);
+	b = bitonic4_reg(hi);
+}
+
+// public name for the merge above: composed with simdsort4_reg() it
+// is the building block for fully-SIMD small mergesorts - sort 4s,
+// merge 4+4 into 8s, merge 8+8 into 16s (see simdsort16) and so on,
+// with the merge staying in registers the whole way
+void simdmerge4x2(__m128i& a, __m128i& b) {
+	bitonic_merge_44(a, b);
+}
+
+void simdsort8(int* __restrict v) {
+	SIMDSORT_PROF(simdsort8);
+	__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+	__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + 4));
+	a = sort4_reg(a);
+	b = sort4_reg(b);
+	bitonic_merge_44(a, b);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), a);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v + 4), b);
+}
+
+void simdsort16(int* __restrict v) {
+	SIMDSORT_PROF(simdsort16);
+	__m128i a0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+	__m128i a1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + 4));
+	__m128i a2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + 8));
+	__m128i a3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + 12));
+	a0 = sort4_reg(a0);
+	a1 = sort4_reg(a1);
+	a2 = sort4_reg(a2);
+	a3 = sort4_reg(a3);
+	bitonic_merge_44(a0, a1);
+	bitonic_merge_44(a2, a3);
+
+	// merge the two sorted 8s: reverse the upper 8 (element order, so
+	// the registers swap too), one vertical level across the halves,
+	// then a bitonic merge of 8 within each half.
+	const __m128i r0 = _mm_shuffle_epi32(a3, 27);
+	const __m128i r1 = _mm_shuffle_epi32(a2, 27);
+	const __m128i lo0 = _mm_min_epi32(a0, r0);
+	const __m128i hi0 = _mm_max_epi32(a0, r0);
+	const __m128i lo1 = _mm_min_epi32(a1, r1);
+	const __m128i hi1 = _mm_max_epi32(a1, r1);
+
+	a0 = _mm_min_epi32(lo0, lo1);
+	a1 = _mm_max_epi32(lo0, lo1);
+	a2 = _mm_min_epi32(hi0, hi1);
+	a3 = _mm_max_epi32(hi0, hi1);
+	a0 = bitonic4_reg(a0);
+	a1 = bitonic4_reg(a1);
+	a2 = bitonic4_reg(a2);
+	a3 = bitonic4_reg(a3);
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), a0);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v + 4), a1);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v + 8), a2);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v + 12), a3);
+}
+
+// 16-bit element kernels: a 128-bit register holds 8 int16_t
+// natively, so there is no reason to widen to int32 and sort scalar.
+// The simdsort6 mask technique extends directly to 16-bit lanes - the
+// compare runs at epi16 width (so each element's two mask bytes
+// agree) and the shuffle indices come in byte pairs. The n = 8 kernel
+// runs the optimal 19-comparator, depth-6 network, one level per
+// pass; levels whose partner gather happens to be a whole-dword
+// permutation use a pshufd immediate instead of a pshufb constant.
+// Encoding per element of a pair (i, j): byte index = base - delta
+// when the compare fires, with base = j and delta = j - i (in bytes),
+// which keeps self for the min side and takes the partner for the max
+
+const __m128i w8_pass3_shf = _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+const __m128i w8_pass5_shf = _mm_setr_epi8(0, 1, 8, 9, 4, 5, 12, 13, 2, 3, 10, 11, 6, 7, 14, 15);
+const __m128i w8_pass6_shf = _mm_setr_epi8(0, 1, 4, 5, 2, 3, 8, 9, 6, 7, 12, 13, 10, 11, 14, 15);
+
+const __m128i w8_pass1_base = _mm_setr_epi8(4, 5, 6, 7, 4, 5, 6, 7, 12, 13, 14, 15, 12, 13, 14, 15);
+const __m128i w8_pass2_base = _mm_setr_epi8(8, 9, 10, 11, 12, 13, 14, 15, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i w8_pass3_base = _mm_setr_epi8(2, 3, 2, 3, 6, 7, 6, 7, 10, 11, 10, 11, 14, 15, 14, 15);
+const __m128i w8_pass4_base = _mm_setr_epi8(0, 1, 2, 3, 8, 9, 10, 11, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i w8_pass5_base = _mm_setr_epi8(0, 1, 8, 9, 4, 5, 12, 13, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i w8_pass6_base = _mm_setr_epi8(0, 1, 4, 5, 4, 5, 8, 9, 8, 9, 12, 13, 12, 13, 14, 15);
+
+const __m128i w8_pass4_delta = _mm_setr_epi8(0, 0, 0, 0, 4, 4, 4, 4, 4, 4, 4, 4, 0, 0, 0, 0);
+const __m128i w8_pass5_delta = _mm_setr_epi8(0, 0, 6, 6, 0, 0, 6, 6, 6, 6, 0, 0, 6, 6, 0, 0);
+const __m128i w8_pass6_delta = _mm_setr_epi8(0, 0, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 0, 0);
+
+void simdsort8_epi16(int16_t* __restrict v) {
+	__m128i b, a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+
+	// level 1: (0,2) (1,3) (4,6) (5,7)
+	b = _mm_shuffle_epi32(a, 177);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_and_si128(b, _mm_set1_epi8(4));
+	b = _mm_sub_epi8(w8_pass1_base, b);
+	a = _mm_shuffle_epi8(a, b);
+
+	// level 2: (0,4) (1,5) (2,6) (3,7)
+	b = _mm_shuffle_epi32(a, 78);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_and_si128(b, _mm_set1_epi8(8));
+	b = _mm_sub_epi8(w8_pass2_base, b);
+	a = _mm_shuffle_epi8(a, b);
+
+	// level 3: (0,1) (2,3) (4,5) (6,7)
+	b = _mm_shuffle_epi8(a, w8_pass3_shf);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_and_si128(b, _mm_set1_epi8(2));
+	b = _mm_sub_epi8(w8_pass3_base, b);
+	a = _mm_shuffle_epi8(a, b);
+
+	// level 4: (2,4) (3,5)
+	b = _mm_shuffle_epi32(a, 216);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_and_si128(b, w8_pass4_delta);
+	b = _mm_sub_epi8(w8_pass4_base, b);
+	a = _mm_shuffle_epi8(a, b);
+
+	// level 5: (1,4) (3,6)
+	b = _mm_shuffle_epi8(a, w8_pass5_shf);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_and_si128(b, w8_pass5_delta);
+	b = _mm_sub_epi8(w8_pass5_base, b);
+	a = _mm_shuffle_epi8(a, b);
+
+	// level 6: (1,2) (3,4) (5,6)
+	b = _mm_shuffle_epi8(a, w8_pass6_shf);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_and_si128(b, w8_pass6_delta);
+	b = _mm_sub_epi8(w8_pass6_base, b);
+	a = _mm_shuffle_epi8(a, b);
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), a);
+}
+
+// 4 int16_t in the low 8 bytes: same 3-level network as simdsort4,
+// partner gathers all expressible as pshuflw/pshufd immediates
+const __m128i w4_pass1_base = _mm_setr_epi8(2, 3, 2, 3, 6, 7, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i w4_pass1_delta = _mm_setr_epi8(2, 2, 2, 2, 2, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0);
+const __m128i w4_pass2_base = _mm_setr_epi8(4, 5, 6, 7, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i w4_pass2_delta = _mm_setr_epi8(4, 4, 4, 4, 4, 4, 4, 4, 0, 0, 0, 0, 0, 0, 0, 0);
+const __m128i w4_pass3_base = _mm_setr_epi8(0, 1, 4, 5, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i w4_pass3_delta = _mm_setr_epi8(0, 0, 2, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+
+void simdsort4_epi16(int16_t* __restrict v) {
+	__m128i b, a = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(v));
+
+	// (0,1) (2,3)
+	b = _mm_shufflelo_epi16(a, 177);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_and_si128(b, w4_pass1_delta);
+	b = _mm_sub_epi8(w4_pass1_base, b);
+	a = _mm_shuffle_epi8(a, b);
+
+	// (0,2) (1,3)
+	b = _mm_shufflelo_epi16(a, 78);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_and_si128(b, w4_pass2_delta);
+	b = _mm_sub_epi8(w4_pass2_base, b);
+	a = _mm_shuffle_epi8(a, b);
+
+	// (1,2)
+	b = _mm_shufflelo_epi16(a, 216);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_and_si128(b, w4_pass3_delta);
+	b = _mm_sub_epi8(w4_pass3_base, b);
+	a = _mm_shuffle_epi8(a, b);
+
+	_mm_storel_epi64(reinterpret_cast<__m128i*>(v), a);
+}
+
+// 64-bit keys. There is no 64-bit integer min/max below AVX-512, so
+// the conditional swap is _mm_cmpgt_epi64 (SSE4.2) feeding
+// _mm_blendv_epi8 - one compare, two blends, same shape as the cmov
+// pair in the scalar tier. A register holds only 2 int64_t, so n = 2
+// is a single in-register swap (compare against the qword-swapped
+// copy, broadcast the low-lane verdict, blend) and n = 4 uses two
+// registers: in-register swaps for (0,1) and (2,3), a vertical swap
+// for (0,2)(1,3), and an alignr to line up element 1 against element
+// 2 for the final comparator.
+void simdsort2_epi64(int64_t* __restrict v) {
+	const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+	const __m128i b = _mm_shuffle_epi32(a, 78);
+	__m128i m = _mm_cmpgt_epi64(a, b);
+	m = _mm_shuffle_epi32(m, 68);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), _mm_blendv_epi8(a, b, m));
+}
+
+void simdsort4_epi64(int64_t* __restrict v) {
+	__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+	__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + 2));
+	__m128i m, t, u;
+
+	// (0,1) and (2,3), in-register
+	t = _mm_shuffle_epi32(a, 78);
+	m = _mm_shuffle_epi32(_mm_cmpgt_epi64(a, t), 68);
+	a = _mm_blendv_epi8(a, t, m);
+	t = _mm_shuffle_epi32(b, 78);
+	m = _mm_shuffle_epi32(_mm_cmpgt_epi64(b, t), 68);
+	b = _mm_blendv_epi8(b, t, m);
+
+	// (0,2) and (1,3), vertical
+	m = _mm_cmpgt_epi64(a, b);
+	t = _mm_blendv_epi8(a, b, m);
+	b = _mm_blendv_epi8(b, a, m);
+	a = t;
+
+	// (1,2): element 1 (high of a) against element 2 (low of b)
+	t = _mm_alignr_epi8(b, a, 8);
+	u = _mm_shuffle_epi32(t, 78);
+	m = _mm_shuffle_epi32(_mm_cmpgt_epi64(t, u), 68);
+	t = _mm_blendv_epi8(t, u, m);
+	a = _mm_unpacklo_epi64(a, t);
+	b = _mm_unpackhi_epi64(t, b);
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), a);
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v + 2), b);
+}
+
+// doubles ride the same epi64 comparators through the monotonic
+// float-to-int transform simdsort4f uses, widened to 64 bits: flip
+// all bits of negatives, just the sign bit of non-negatives (done
+// with a cmpgt-against-zero sign mask, since psraq doesn't exist
+// below AVX-512). Same NaN policy as simdsort4f: the transform
+// induces a total order, so the output is always a permutation -
+// positive NaNs above +inf, negative NaNs below -inf, -0.0 before 0.0
+static inline __m128i __to_ordered_epi64(__m128i a) {
+	const __m128i m = _mm_cmpgt_epi64(_mm_setzero_si128(), a);
+	return _mm_xor_si128(a, _mm_and_si128(m, _mm_set1_epi64x(INT64_MAX)));
+}
+
+void simdsort2d(double* __restrict v) {
+	__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+	a = __to_ordered_epi64(a);
+	const __m128i b = _mm_shuffle_epi32(a, 78);
+	__m128i m = _mm_cmpgt_epi64(a, b);
+	m = _mm_shuffle_epi32(m, 68);
+	a = __to_ordered_epi64(_mm_blendv_epi8(a, b, m));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), a);
+}
+
+void simdsort4d(double* __restrict v) {
+	__m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v));
+	__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + 2));
+	__m128i m, t, u;
+	a = __to_ordered_epi64(a);
+	b = __to_ordered_epi64(b);
+
+	t = _mm_shuffle_epi32(a, 78);
+	m = _mm_shuffle_epi32(_mm_cmpgt_epi64(a, t), 68);
+	a = _mm_blendv_epi8(a, t, m);
+	t = _mm_shuffle_epi32(b, 78);
+	m = _mm_shuffle_epi32(_mm_cmpgt_epi64(b, t), 68);
+	b = _mm_blendv_epi8(b, t, m);
+
+	m = _mm_cmpgt_epi64(a, b);
+	t = _mm_blendv_epi8(a, b, m);
+	b = _mm_blendv_epi8(b, a, m);
+	a = t;
+
+	t = _mm_alignr_epi8(b, a, 8);
+	u = _mm_shuffle_epi32(t, 78);
+	m = _mm_shuffle_epi32(_mm_cmpgt_epi64(t, u), 68);
+	t = _mm_blendv_epi8(t, u, m);
+	a = _mm_unpacklo_epi64(a, t);
+	b = _mm_unpackhi_epi64(t, b);
+
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v), __to_ordered_epi64(a));
+	_mm_storeu_si128(reinterpret_cast<__m128i*>(v + 2), __to_ordered_epi64(b));
+}
+
+// scalar fallback for pre-SSE4.2 parts (and doubles via punning): the
+// sort4a cmov sequence on 64-bit registers. sort4a64.asm is the
+// assembly version for when the compiler branches anyway
+void sort4_epi64(int64_t* __restrict v) {
+#define __kmin(a, b) (a < b ? a : b)
+#define __kmax(a, b) (a < b ? b : a)
+#define __kswap(x,y) { int64_t a = __kmin(v[x], v[y]); int64_t b = __kmax(v[x], v[y]); v[x] = a; v[y] = b; }
+	__kswap(0, 1);
+	__kswap(2, 3);
+	__kswap(0, 2);
+	__kswap(1, 3);
+	__kswap(1, 2);
+#undef __kswap
+#undef __kmax
+#undef __kmin
+}
+
+// sort_small: n known only at runtime. A chain of size tests
+// mispredicts badly on mixed-size workloads, so this is a jump table
+// indexed by n - one indirect call, no per-size caller logic. Sizes
+// with a dedicated kernel go straight to it; the others pad to the
+// next kernel size with INT32_MAX sentinels (a sorting network doesn't
+// care what the values are, and the sentinels all sort to the top, so
+// the first n outputs are exactly the sorted inputs) and still take
+// the branchless SIMD path. The pad copies are exact-size memcpys
+// into a local buffer, so no bytes past v[n-1] are read or written
+
+static void sort_small_nop(int* __restrict, size_t) {
+}
+static void sort_small_2(int* __restrict v, size_t) {
+	sort2(v);
+}
+static void sort_small_4(int* __restrict v, size_t) {
+	simdsort4(v);
+}
+static void sort_small_8(int* __restrict v, size_t) {
+	simdsort8(v);
+}
+static void sort_small_16(int* __restrict v, size_t) {
+	simdsort16(v);
+}
+static void sort_small_pad4(int* __restrict v, size_t n) {
+	int buf[4] = { 0, 0, INT32_MAX, INT32_MAX };
+	memcpy(buf, v, n * sizeof(int));
+	simdsort4(buf);
+	memcpy(v, buf, n * sizeof(int));
+}
+static void sort_small_pad8(int* __restrict v, size_t n) {
+	int buf[8];
+	for (size_t i = 0; i < 8; ++i)
+		buf[i] = INT32_MAX;
+	memcpy(buf, v, n * sizeof(int));
+	simdsort8(buf);
+	memcpy(v, buf, n * sizeof(int));
+}
+static void sort_small_pad16(int* __restrict v, size_t n) {
+	int buf[16];
+	for (size_t i = 0; i < 16; ++i)
+		buf[i] = INT32_MAX;
+	memcpy(buf, v, n * sizeof(int));
+	simdsort16(buf);
+	memcpy(v, buf, n * sizeof(int));
+}
+
+typedef void (*sort_small_fn)(int* __restrict, size_t);
+static const sort_small_fn sort_small_tab[17] = {
+	sort_small_nop, sort_small_nop, sort_small_2, sort_small_pad4,
+	sort_small_4, sort_small_pad8, sort_small_pad8, sort_small_pad8,
+	sort_small_8, sort_small_pad16, sort_small_pad16, sort_small_pad16,
+	sort_small_pad16, sort_small_pad16, sort_small_pad16, sort_small_pad16,
+	sort_small_16
+};
+
+void sort_small(int* __restrict v, size_t n) {
+	SIMDSORT_PROF(sort_small);
+	sort_small_tab[n](v, n);
+}
+
+#if defined(__AVX512VBMI__) && defined(__AVX512BW__)
+// AVX-512 batch path for the 6 int8_t sort: 16 arrays (96 bytes) per
+// pass. VPERMB makes the awkward stride-6 byte transpose a pair of
+// two-source permutes: one gathers columns 0-3 of all 16 arrays into
+// one zmm, the other gathers columns 4-5. The 12-comparator network
+// then runs vertically on the 16-byte columns with plain min/max, and
+// two more permutes put everything back in array order. Mask registers
+// cover tails whose count isn't a multiple of 16.
+const __m512i pack6_cols0123 = _mm512_set_epi8(
+	93, 87, 81, 75, 69, 63, 57, 51, 45, 39, 33, 27, 21, 15, 9, 3,
+	92, 86, 80, 74, 68, 62, 56, 50, 44, 38, 32, 26, 20, 14, 8, 2,
+	91, 85, 79, 73, 67, 61, 55, 49, 43, 37, 31, 25, 19, 13, 7, 1,
+	90, 84, 78, 72, 66, 60, 54, 48, 42, 36, 30, 24, 18, 12, 6, 0);
+const __m512i pack6_cols45 = _mm512_set_epi8(
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	95, 89, 83, 77, 71, 65, 59, 53, 47, 41, 35, 29, 23, 17, 11, 5,
+	94, 88, 82, 76, 70, 64, 58, 52, 46, 40, 34, 28, 22, 16, 10, 4);
+const __m512i unpack6_lo = _mm512_set_epi8(
+	58, 42, 26, 10, 89, 73, 57, 41, 25, 9, 88, 72, 56, 40, 24, 8,
+	87, 71, 55, 39, 23, 7, 86, 70, 54, 38, 22, 6, 85, 69, 53, 37,
+	21, 5, 84, 68, 52, 36, 20, 4, 83, 67, 51, 35, 19, 3, 82, 66,
+	50, 34, 18, 2, 81, 65, 49, 33, 17, 1, 80, 64, 48, 32, 16, 0);
+const __m512i unpack6_hi = _mm512_set_epi8(
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	95, 79, 63, 47, 31, 15, 94, 78, 62, 46, 30, 14, 93, 77, 61, 45,
+	29, 13, 92, 76, 60, 44, 28, 12, 91, 75, 59, 43, 27, 11, 90, 74);
+
+static void simdsort6x16_masked(char* __restrict v, const __mmask64 m0, const __mmask64 m1) {
+	const __m512i z0 = _mm512_maskz_loadu_epi8(m0, v);
+	const __m512i z1 = _mm512_maskz_loadu_epi8(m1, v + 64);
+
+	const __m512i zA = _mm512_permutex2var_epi8(z0, pack6_cols0123, z1);
+	const __m512i zB = _mm512_permutex2var_epi8(z0, pack6_cols45, z1);
+	__m128i c0 = _mm512_castsi512_si128(zA);
+	__m128i c1 = _mm512_extracti32x4_epi32(zA, 1);
+	__m128i c2 = _mm512_extracti32x4_epi32(zA, 2);
+	__m128i c3 = _mm512_extracti32x4_epi32(zA, 3);
+	__m128i c4 = _mm512_castsi512_si128(zB);
+	__m128i c5 = _mm512_extracti32x4_epi32(zB, 1);
+
+#define __kvswap(x, y) { const __m128i lo = _mm_min_epi8(x, y); const __m128i hi = _mm_max_epi8(x, y); x = lo; y = hi; }
+	__kvswap(c1, c2);
+	__kvswap(c0, c2);
+	__kvswap(c0, c1);
+	__kvswap(c4, c5);
+	__kvswap(c3, c5);
+	__kvswap(c3, c4);
+	__kvswap(c0, c3);
+	__kvswap(c1, c4);
+	__kvswap(c2, c5);
+	__kvswap(c2, c4);
+	__kvswap(c1, c3);
+	__kvswap(c2, c3);
+#undef __kvswap
+
+	__m512i sA = _mm512_castsi128_si512(c0);
+	sA = _mm512_inserti32x4(sA, c1, 1);
+	sA = _mm512_inserti32x4(sA, c2, 2);
+	sA = _mm512_inserti32x4(sA, c3, 3);
+	__m512i sB = _mm512_castsi128_si512(c4);
+	sB = _mm512_inserti32x4(sB, c5, 1);
+
+	_mm512_mask_storeu_epi8(v, m0, _mm512_permutex2var_epi8(sA, unpack6_lo, sB));
+	_mm512_mask_storeu_epi8(v + 64, m1, _mm512_permutex2var_epi8(sA, unpack6_hi, sB));
+}
+
+void simdsort6_batch(char* __restrict v, size_t count) {
+	SIMDSORT_PROF(simdsort6_batch);
+	for (; count >= 16; count -= 16, v += 96)
+		simdsort6x16_masked(v, ~0ULL, (1ULL << 32) - 1);
+	if (count) {
+		// 6*count valid bytes, 6 <= bytes <= 90
+		const size_t bytes = 6 * count;
+		const __mmask64 m0 = bytes >= 64 ? ~0ULL : (1ULL << bytes) - 1;
+		const __mmask64 m1 = bytes > 64 ? (1ULL << (bytes - 64)) - 1 : 0;
+		simdsort6x16_masked(v, m0, m1);
+	}
+}
+#else
+void simdsort6_batch(char* __restrict v, size_t count) {
+	SIMDSORT_PROF(simdsort6_batch);
+	for (size_t i = 0; i < count; ++i, v += 6)
+		simdsort6(v);
+}
+#endif
+
+#ifdef __AVX2__
+// vertical (column-wise) formulation: transpose 8 arrays of 4 int32_t
+// so each ymm register holds one element position of all 8 arrays, run
+// the depth-3/size-5 network as plain min/max (one comparator = one
+// _mm256_min_epi32 + one _mm256_max_epi32, fully parallel across the 8
+// arrays), then transpose back. Both transposes use only in-lane
+// unpacks, so the 3-cycle interlane penalty never applies.
+void simdsort4x8(int* __restrict v) {
+	const __m256i r0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v));
+	const __m256i r1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + 8));
+	const __m256i r2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + 16));
+	const __m256i r3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v + 24));
+
+	const __m256i t0 = _mm256_unpacklo_epi32(r0, r1);
+	const __m256i t1 = _mm256_unpackhi_epi32(r0, r1);
+	const __m256i t2 = _mm256_unpacklo_epi32(r2, r3);
+	const __m256i t3 = _mm256_unpackhi_epi32(r2, r3);
+	__m256i c0 = _mm256_unpacklo_epi64(t0, t2);
+	__m256i c1 = _mm256_unpackhi_epi64(t0, t2);
+	__m256i c2 = _mm256_unpacklo_epi64(t1, t3);
+	__m256i c3 = _mm256_unpackhi_epi64(t1, t3);
+
+#define __kvswap(x, y) { const __m256i lo = _mm256_min_epi32(x, y); const __m256i hi = _mm256_max_epi32(x, y); x = lo; y = hi; }
+	__kvswap(c0, c1);
+	__kvswap(c2, c3);
+	__kvswap(c0, c2);
+	__kvswap(c1, c3);
+	__kvswap(c1, c2);
+#undef __kvswap
+
+	const __m256i u0 = _mm256_unpacklo_epi32(c0, c1);
+	const __m256i u1 = _mm256_unpackhi_epi32(c0, c1);
+	const __m256i u2 = _mm256_unpacklo_epi32(c2, c3);
+	const __m256i u3 = _mm256_unpackhi_epi32(c2, c3);
+
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(v), _mm256_unpacklo_epi64(u0, u2));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(v + 8), _mm256_unpackhi_epi64(u0, u2));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(v + 16), _mm256_unpacklo_epi64(u1, u3));
+	_mm256_storeu_si256(reinterpret_cast<__m256i*>(v + 24), _mm256_unpackhi_epi64(u1, u3));
+}
+#endif
+
+// structure-of-arrays batch: record i lives at (col0[i], col1[i],
+// col2[i], col3[i]) instead of 4 contiguous ints. This is the vertical
+// formulation of simdsort4x8 with the transposes deleted - if the
+// producer can emit columns directly, the loads ARE the transpose, and
+// the whole sort is nothing but vertical min/max: no shuffles, no
+// lane-crossing, no per-pass constants. One comparator costs exactly
+// one min + one max at full register width, so this is the cheapest
+// per-record path in the library when the layout allows it. The
+// converters below handle the cases where it doesn't.
+#define __vswap(mn, mx, x, y) { const auto lo = mn(x, y); const auto hi = mx(x, y); x = lo; y = hi; }
+void simdsort4_soa(int* __restrict col0, int* __restrict col1, int* __restrict col2, int* __restrict col3, size_t count) {
+	size_t i = 0;
+#ifdef __AVX2__
+	for (; i + 8 <= count; i += 8) {
+		__m256i c0 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(col0 + i));
+		__m256i c1 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(col1 + i));
+		__m256i c2 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(col2 + i));
+		__m256i c3 = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(col3 + i));
+		__vswap(_mm256_min_epi32, _mm256_max_epi32, c0, c1);
+		__vswap(_mm256_min_epi32, _mm256_max_epi32, c2, c3);
+		__vswap(_mm256_min_epi32, _mm256_max_epi32, c0, c2);
+		__vswap(_mm256_min_epi32, _mm256_max_epi32, c1, c3);
+		__vswap(_mm256_min_epi32, _mm256_max_epi32, c1, c2);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(col0 + i), c0);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(col1 + i), c1);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(col2 + i), c2);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(col3 + i), c3);
+	}
+#endif
+	for (; i + 4 <= count; i += 4) {
+		__m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col0 + i));
+		__m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col1 + i));
+		__m128i c2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col2 + i));
+		__m128i c3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col3 + i));
+		__vswap(_mm_min_epi32, _mm_max_epi32, c0, c1);
+		__vswap(_mm_min_epi32, _mm_max_epi32, c2, c3);
+		__vswap(_mm_min_epi32, _mm_max_epi32, c0, c2);
+		__vswap(_mm_min_epi32, _mm_max_epi32, c1, c3);
+		__vswap(_mm_min_epi32, _mm_max_epi32, c1, c2);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(col0 + i), c0);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(col1 + i), c1);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(col2 + i), c2);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(col3 + i), c3);
+	}
+	// tail: same network, scalar min/max (compiles to cmov)
+	for (; i < count; ++i) {
+		int a = col0[i], b = col1[i], c = col2[i], d = col3[i];
+		int t;
+		t = a < b ? a : b; b = a < b ? b : a; a = t;
+		t = c < d ? c : d; d = c < d ? d : c; c = t;
+		t = a < c ? a : c; c = a < c ? c : a; a = t;
+		t = b < d ? b : d; d = b < d ? d : b; b = t;
+		t = b < c ? b : c; c = b < c ? c : b; b = t;
+		col0[i] = a; col1[i] = b; col2[i] = c; col3[i] = d;
+	}
+}
+#undef __vswap
+
+// bulk AoS -> SoA: scatter 'count' contiguous 4-int records into the
+// four column arrays. 4 records at a time through the standard 4x4
+// unpack transpose, so each 64-byte line of input becomes one aligned
+// 16-byte store per column
+void simdsort4_aos_to_soa(const int* __restrict v, int* __restrict col0, int* __restrict col1, int* __restrict col2, int* __restrict col3, size_t count) {
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i r0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + 4 * i));
+		const __m128i r1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + 4 * i + 4));
+		const __m128i r2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + 4 * i + 8));
+		const __m128i r3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(v + 4 * i + 12));
+		const __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+		const __m128i t1 = _mm_unpackhi_epi32(r0, r1);
+		const __m128i t2 = _mm_unpacklo_epi32(r2, r3);
+		const __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(col0 + i), _mm_unpacklo_epi64(t0, t2));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(col1 + i), _mm_unpackhi_epi64(t0, t2));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(col2 + i), _mm_unpacklo_epi64(t1, t3));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(col3 + i), _mm_unpackhi_epi64(t1, t3));
+	}
+	for (; i < count; ++i) {
+		col0[i] = v[4 * i];
+		col1[i] = v[4 * i + 1];
+		col2[i] = v[4 * i + 2];
+		col3[i] = v[4 * i + 3];
+	}
+}
+
+// bulk SoA -> AoS: the same transpose run in reverse
+void simdsort4_soa_to_aos(const int* __restrict col0, const int* __restrict col1, const int* __restrict col2, const int* __restrict col3, int* __restrict v, size_t count) {
+	size_t i = 0;
+	for (; i + 4 <= count; i += 4) {
+		const __m128i c0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col0 + i));
+		const __m128i c1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col1 + i));
+		const __m128i c2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col2 + i));
+		const __m128i c3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(col3 + i));
+		const __m128i t0 = _mm_unpacklo_epi32(c0, c1);
+		const __m128i t1 = _mm_unpackhi_epi32(c0, c1);
+		const __m128i t2 = _mm_unpacklo_epi32(c2, c3);
+		const __m128i t3 = _mm_unpackhi_epi32(c2, c3);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(v + 4 * i), _mm_unpacklo_epi64(t0, t2));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(v + 4 * i + 4), _mm_unpackhi_epi64(t0, t2));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(v + 4 * i + 8), _mm_unpacklo_epi64(t1, t3));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(v + 4 * i + 12), _mm_unpackhi_epi64(t1, t3));
+	}
+	for (; i < count; ++i) {
+		v[4 * i] = col0[i];
+		v[4 * i + 1] = col1[i];
+		v[4 * i + 2] = col2[i];
+		v[4 * i + 3] = col3[i];
+	}
+}
+
+// gather/sort/scatter for non-contiguous records: group g is the four
+// ints base[indices[4g]] .. base[indices[4g+3]], sorted into the
+// contiguous out[4g..4g+3]. Scattered loads, not the sort, dominate
+// this workload, so the loop does two things about them: software
+// prefetch runs PF groups ahead of the sort (the index stream is
+// sequential and costs nothing; the data pointers it chases are the
+// random part, and by the time the sort reaches a group its lines are
+// in flight or resident), and two groups stay in flight so one
+// group's gather overlaps the other's shuffle passes, same as
+// simdsort4_batch. With AVX2 the gather itself is one vpgatherdd;
+// otherwise four scalar loads assembled with setr.
+static inline __m128i __gather4(const int* __restrict base, const int* __restrict idx) {
+#ifdef __AVX2__
+	return _mm_i32gather_epi32(base, _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx)), 4);
+#else
+	return _mm_setr_epi32(base[idx[0]], base[idx[1]], base[idx[2]], base[idx[3]]);
+#endif
+}
+
+void simdsort4_gather(const int* __restrict base, const int* __restrict indices, size_t count, int* __restrict out) {
+	static const size_t PF = 8;
+	size_t i = 0;
+	for (; i + 2 <= count; i += 2) {
+		if (i + PF + 2 <= count) {
+			const int* const pi = indices + 4 * (i + PF);
+			_mm_prefetch(reinterpret_cast<const char*>(base + pi[0]), _MM_HINT_T0);
+			_mm_prefetch(reinterpret_cast<const char*>(base + pi[1]), _MM_HINT_T0);
+			_mm_prefetch(reinterpret_cast<const char*>(base + pi[2]), _MM_HINT_T0);
+			_mm_prefetch(reinterpret_cast<const char*>(base + pi[3]), _MM_HINT_T0);
+			_mm_prefetch(reinterpret_cast<const char*>(base + pi[4]), _MM_HINT_T0);
+			_mm_prefetch(reinterpret_cast<const char*>(base + pi[5]), _MM_HINT_T0);
+			_mm_prefetch(reinterpret_cast<const char*>(base + pi[6]), _MM_HINT_T0);
+			_mm_prefetch(reinterpret_cast<const char*>(base + pi[7]), _MM_HINT_T0);
+		}
+		const __m128i a = simdsort4_reg(__gather4(base, indices + 4 * i));
+		const __m128i b = simdsort4_reg(__gather4(base, indices + 4 * i + 4));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * i), a);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * i + 4), b);
+	}
+	if (i < count)
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 4 * i), simdsort4_reg(__gather4(base, indices + 4 * i)));
+}
+
+const __m128i pass1_shf = _mm_setr_epi8(1, 0, 3, 2, 5, 4, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i pass1_add = _mm_setr_epi8(1, 1, 3, 3, 5, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i pass2_shf = _mm_setr_epi8(2, 4, 0, 5, 1, 3, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i pass2_and = _mm_setr_epi8(-2, -3, -2, -2, -3, -2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+const __m128i pass2_add = _mm_setr_epi8(2, 4, 2, 5, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i pass4_shf = _mm_setr_epi8(0, 2, 1, 4, 3, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i pass4_add = _mm_setr_epi8(0, 2, 2, 4, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i pass5_shf = _mm_setr_epi8(0, 1, 3, 2, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i pass5_add = _mm_setr_epi8(0, 1, 3, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+// register-to-register core: sorts the 6 int8_t in the low 6 bytes of
+// 'a' (the upper 10 bytes are passed through untouched by every pass
+// constant, so they come back as they went in). The pointer versions
+// below are wrappers around this
+__m128i simdsort6_reg(__m128i a) {
+	__m128i b;
+
+	b = _mm_shuffle_epi8(a, pass1_shf);
+	b = _mm_cmpgt_epi8(b, a);
+	b = _mm_add_epi8(b, pass1_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, pass2_shf);
+	b = _mm_cmpgt_epi8(b, a);
+	b = _mm_and_si128(b, pass2_and);
+	b = _mm_add_epi8(b, pass2_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, pass1_shf);
+	b = _mm_cmpgt_epi8(b, a);
+	b = _mm_add_epi8(b, pass1_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, pass4_shf);
+	b = _mm_cmpgt_epi8(b, a);
+	b = _mm_add_epi8(b, pass4_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, pass5_shf);
+	b = _mm_cmpgt_epi8(b, a);
+	b = _mm_add_epi8(b, pass5_add);
+	return _mm_shuffle_epi8(a, b);
+}
+
+void simdsort6(char* __restrict v) {
+	SIMDSORT_PROF(simdsort6);
+	__m128i a = _mm_cvtsi32_si128(*reinterpret_cast<const int*>(v));
+	a = _mm_insert_epi16(a, *reinterpret_cast<const int*>(v + 4), 2);
+	a = simdsort6_reg(a);
+	*reinterpret_cast<int*>(v) = _mm_cvtsi128_si32(a);
+	*reinterpret_cast<int16_t*>(v + 4) = _mm_extract_epi16(a, 2);
+}
+
+void simdsort6(const char* __restrict in, char* __restrict out) {
+	__m128i a = _mm_cvtsi32_si128(*reinterpret_cast<const int*>(in));
+	a = _mm_insert_epi16(a, *reinterpret_cast<const int*>(in + 4), 2);
+	a = simdsort6_reg(a);
+	*reinterpret_cast<int*>(out) = _mm_cvtsi128_si32(a);
+	*reinterpret_cast<int16_t*>(out + 4) = _mm_extract_epi16(a, 2);
+}
+
+// the 'no constants' treatment for the 6 int8_t sort. simdsort6's
+// eight 16-byte constants are 128 bytes of L1 - two whole lines -
+// which a cold call site pays for on every invocation. Byte-granular
+// pshufb masks can't be built from immediates, so this version moves
+// the problem to a domain where everything CAN be: sign-extend the 6
+// bytes to words (pmovsxbw, no constant), run an odd-even
+// transposition network on the words - the brick over (0,1)(2,3)(4,5)
+// is pshuflw/pshufhw immediates and the brick over (1,2)(3,4) is two
+// palignr rotations stitched with immediate word blends - resolving
+// each comparator with word min/max and an immediate blend, then
+// saturating-pack straight back to bytes. 6 levels of 15 comparators
+// instead of 5 levels of 12, so it loses to simdsort6 hot; it wins
+// when simdsort6 would start with two constant misses.
+void simdsort6_noconstants(char* __restrict v) {
+	__m128i a = _mm_cvtsi32_si128(*reinterpret_cast<const int*>(v));
+	a = _mm_insert_epi16(a, *reinterpret_cast<const int*>(v + 4), 2);
+	a = _mm_cvtepi8_epi16(a);
+
+	for (int round = 0; round < 3; ++round) {
+		// (0,1) (2,3) (4,5): pairs sit inside dwords, so the partner
+		// gather is just the word-swap immediates ((6,7) rides along
+		// harmlessly - those words never get packed back)
+		__m128i p = _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, 177), 177);
+		__m128i lo = _mm_min_epi16(a, p);
+		__m128i hi = _mm_max_epi16(a, p);
+		a = _mm_blend_epi16(lo, hi, 42);
+
+		// (1,2) (3,4): rotate one word each way, pick each lane's
+		// partner with immediate blends (self for 0, 5 so their
+		// min = max = identity)
+		const __m128i r = _mm_alignr_epi8(a, a, 2);
+		const __m128i l = _mm_alignr_epi8(a, a, 14);
+		p = _mm_blend_epi16(r, l, 20);
+		p = _mm_blend_epi16(p, a, 225);
+		lo = _mm_min_epi16(a, p);
+		hi = _mm_max_epi16(a, p);
+		a = _mm_blend_epi16(lo, hi, 20);
+	}
+
+	a = _mm_packs_epi16(a, a);
+	*reinterpret_cast<int*>(v) = _mm_cvtsi128_si32(a);
+	*reinterpret_cast<int16_t*>(v + 4) = _mm_extract_epi16(a, 2);
+}
+
+
+// key-value version of the 6 int8_t sort. The key bytes are widened to
+// int16 lanes with the lane's own index packed into the low byte, so
+// every combined value is distinct and the runtime shuffle masks are
+// guaranteed to be permutations even with duplicate keys (duplicates
+// keep their original order, i.e. this variant is stable). The 5
+// passes are the epi16 analogue of simdsort6's - same network, byte
+// offsets doubled. At the end the high bytes are the sorted keys and
+// the low bytes are the sort permutation, which a single pshufb
+// applies to the payload.
+const __m128i kv_pack6_idx = _mm_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i kv_pass1_shf = _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 12, 13, 14, 15);
+const __m128i kv_pass1_add = _mm_setr_epi8(2, 3, 2, 3, 6, 7, 6, 7, 10, 11, 10, 11, 12, 13, 14, 15);
+const __m128i kv_pass2_shf = _mm_setr_epi8(4, 5, 8, 9, 0, 1, 10, 11, 2, 3, 6, 7, 12, 13, 14, 15);
+const __m128i kv_pass2_and = _mm_setr_epi8(-4, -4, -6, -6, -4, -4, -4, -4, -6, -6, -4, -4, 0, 0, 0, 0);
+const __m128i kv_pass2_add = _mm_setr_epi8(4, 5, 8, 9, 4, 5, 10, 11, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i kv_pass4_shf = _mm_setr_epi8(0, 1, 4, 5, 2, 3, 8, 9, 6, 7, 10, 11, 12, 13, 14, 15);
+const __m128i kv_pass4_add = _mm_setr_epi8(0, 1, 4, 5, 4, 5, 8, 9, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i kv_pass5_shf = _mm_setr_epi8(0, 1, 2, 3, 6, 7, 4, 5, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i kv_pass5_add = _mm_setr_epi8(0, 1, 2, 3, 6, 7, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+const __m128i kv_keys6 = _mm_setr_epi8(1, 3, 5, 7, 9, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+const __m128i kv_perm6 = _mm_setr_epi8(0, 2, 4, 6, 8, 10, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+void simdsort6kv(char* __restrict v, char* __restrict p) {
+	__m128i b, a = _mm_cvtsi32_si128(*reinterpret_cast<const int*>(v));
+	a = _mm_insert_epi16(a, *reinterpret_cast<const int*>(v + 4), 2);
+	a = _mm_unpacklo_epi8(kv_pack6_idx, a);
+
+	b = _mm_shuffle_epi8(a, kv_pass1_shf);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_add_epi8(b, b);
+	b = _mm_add_epi8(b, kv_pass1_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, kv_pass2_shf);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_and_si128(b, kv_pass2_and);
+	b = _mm_add_epi8(b, kv_pass2_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, kv_pass1_shf);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_add_epi8(b, b);
+	b = _mm_add_epi8(b, kv_pass1_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, kv_pass4_shf);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_add_epi8(b, b);
+	b = _mm_add_epi8(b, kv_pass4_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, kv_pass5_shf);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_add_epi8(b, b);
+	b = _mm_add_epi8(b, kv_pass5_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	__m128i q = _mm_cvtsi32_si128(*reinterpret_cast<const int*>(p));
+	q = _mm_insert_epi16(q, *reinterpret_cast<const int*>(p + 4), 2);
+	q = _mm_shuffle_epi8(q, _mm_shuffle_epi8(a, kv_perm6));
+	const __m128i keys = _mm_shuffle_epi8(a, kv_keys6);
+
+	*reinterpret_cast<int*>(v) = _mm_cvtsi128_si32(keys);
+	*reinterpret_cast<int16_t*>(v + 4) = _mm_extract_epi16(keys, 2);
+	*reinterpret_cast<int*>(p) = _mm_cvtsi128_si32(q);
+	*reinterpret_cast<int16_t*>(p + 4) = _mm_extract_epi16(q, 2);
+}
+
+// stable variant of the 6 int8_t sort. simdsort6's byte network is
+// not stable (comparators like (0,2) can carry an element past an
+// equal one), so this reuses the tagged-word machinery above: each
+// key is widened to an int16 lane as (key << 8) | lane index, which
+// makes every combined value distinct and breaks each tie by original
+// position - exactly the stability guarantee, bought with the 8 spare
+// bits already sitting in the register instead of a second register
+// of indices. Same 5 kv passes; at the end the high bytes are the
+// stably sorted keys and the permutation in the low bytes is simply
+// dropped. One register the whole way, same cost as simdsort6kv minus
+// the payload permute.
+void simdsort6_stable(char* __restrict v) {
+	__m128i b, a = _mm_cvtsi32_si128(*reinterpret_cast<const int*>(v));
+	a = _mm_insert_epi16(a, *reinterpret_cast<const int*>(v + 4), 2);
+	a = _mm_unpacklo_epi8(kv_pack6_idx, a);
+
+	b = _mm_shuffle_epi8(a, kv_pass1_shf);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_add_epi8(b, b);
+	b = _mm_add_epi8(b, kv_pass1_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, kv_pass2_shf);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_and_si128(b, kv_pass2_and);
+	b = _mm_add_epi8(b, kv_pass2_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, kv_pass1_shf);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_add_epi8(b, b);
+	b = _mm_add_epi8(b, kv_pass1_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, kv_pass4_shf);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_add_epi8(b, b);
+	b = _mm_add_epi8(b, kv_pass4_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, kv_pass5_shf);
+	b = _mm_cmpgt_epi16(b, a);
+	b = _mm_add_epi8(b, b);
+	b = _mm_add_epi8(b, kv_pass5_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	a = _mm_shuffle_epi8(a, kv_keys6);
+	*reinterpret_cast<int*>(v) = _mm_cvtsi128_si32(a);
+	*reinterpret_cast<int16_t*>(v + 4) = _mm_extract_epi16(a, 2);
+}
+
+// unsigned version of the 6 int8_t sort: XOR the sign bit at load and
+// store so uint8 order maps onto the int8 order the passes compare in.
+void simdsort6u(uint8_t* __restrict v) {
+	__m128i b, a = _mm_cvtsi32_si128(*reinterpret_cast<const int*>(v));
+	a = _mm_insert_epi16(a, *reinterpret_cast<const int*>(v + 4), 2);
+	const __m128i bias = _mm_set1_epi8(-128);
+	a = _mm_xor_si128(a, bias);
+
+	b = _mm_shuffle_epi8(a, pass1_shf);
+	b = _mm_cmpgt_epi8(b, a);
+	b = _mm_add_epi8(b, pass1_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, pass2_shf);
+	b = _mm_cmpgt_epi8(b, a);
+	b = _mm_and_si128(b, pass2_and);
+	b = _mm_add_epi8(b, pass2_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, pass1_shf);
+	b = _mm_cmpgt_epi8(b, a);
+	b = _mm_add_epi8(b, pass1_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, pass4_shf);
+	b = _mm_cmpgt_epi8(b, a);
+	b = _mm_add_epi8(b, pass4_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	b = _mm_shuffle_epi8(a, pass5_shf);
+	b = _mm_cmpgt_epi8(b, a);
+	b = _mm_add_epi8(b, pass5_add);
+	a = _mm_shuffle_epi8(a, b);
+
+	a = _mm_xor_si128(a, bias);
+	*reinterpret_cast<int*>(v) = _mm_cvtsi128_si32(a);
+	*reinterpret_cast<int16_t*>(v + 4) = _mm_extract_epi16(a, 2);
+}
+
+// works but very slow compared to scalar version because
+// of repeated inter-lane (3 cycle latency)
+
+//const __m256i pass1_shfi = _mm256_setr_epi32(1, 0, 3, 2, 5, 4, 6, 7);
+//const __m256i pass1_addi = _mm256_setr_epi32(1, 1, 3, 3, 5, 5, 6, 7);
+//const __m256i pass2_shfi = _mm256_setr_epi32(2, 4, 0, 5, 1, 3, 6, 7);
+//const __m256i pass2_andi = _mm256_setr_epi32(-2, -3, -2, -2, -3, -2, 0, 0);
+//const __m256i pass2_addi = _mm256_setr_epi32(2, 4, 2, 5, 4, 5, 6, 7);
+//const __m256i pass4_shfi = _mm256_setr_epi32(0, 2, 1, 4, 3, 5, 6, 7);
+//const __m256i pass4_addi = _mm256_setr_epi32(0, 2, 2, 4, 4, 5, 6, 7);
+//const __m256i pass5_shfi = _mm256_setr_epi32(0, 1, 3, 2, 4, 5, 6, 7);
+//const __m256i pass5_addi = _mm256_setr_epi32(0, 1, 3, 3, 4, 5, 6, 7);
+//void simdsort6(int* __restrict v) {
+//	__m256i b, a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(v));
+//	
+//	b = _mm256_permutevar8x32_epi32(a, pass1_shfi);
+//	b = _mm256_cmpgt_epi32(b, a);
+//	b = _mm256_add_epi32(b, pass1_addi);
+//	a = _mm256_permutevar8x32_epi32(a, b);
+//
+//	b = _mm256_permutevar8x32_epi32(a, pass2_shfi);
+//	b = _mm256_cmpgt_epi32(b, a);
+//	b = _mm256_and_si256(b, pass2_andi);
+//	b = _mm256_add_epi32(b, pass2_addi);
+//	a = _mm256_permutevar8x32_epi32(a, b);
+//
+//	b = _mm256_permutevar8x32_epi32(a, pass1_shfi);
+//	b = _mm256_cmpgt_epi32(b, a);
+//	b = _mm256_add_epi32(b, pass1_addi);
+//	a = _mm256_permutevar8x32_epi32(a, b);
+//
+//	b = _mm256_permutevar8x32_epi32(a, pass4_shfi);
+//	b = _mm256_cmpgt_epi32(b, a);
+//	b = _mm256_add_epi32(b, pass4_addi);
+//	a = _mm256_permutevar8x32_epi32(a, b);
+//
+//	b = _mm256_permutevar8x32_epi32(a, pass5_shfi);
+//	b = _mm256_cmpgt_epi32(b, a);
+//	b = _mm256_add_epi32(b, pass5_addi);
+//	a = _mm256_permutevar8x32_epi32(a, b);
+//
+//	_mm_storeu_si128((__m128i*)v, _mm256_castsi256_si128(a));
+//	*reinterpret_cast<long long*>(v + 4) = _mm_cvtsi128_si64(_mm256_extracti128_si256(a, 1));
+//}
+// out-of-line definitions for the sortN comparator tables. Pre-C++17,
+// a static constexpr data member is not implicitly inline, and sortN's
+// range-for odr-uses the arrays (binding a reference), so without
+// these every -std=c++14 build - including MSVC's default /std:c++14 -
+// dies at link with 'undefined reference to detail::network<N>::pairs'.
+// Redundant but harmless under C++17 and later.
+namespace detail {
+constexpr uint8_t network<2>::pairs[][2];
+constexpr uint8_t network<3>::pairs[][2];
+constexpr uint8_t network<4>::pairs[][2];
+constexpr uint8_t network<5>::pairs[][2];
+constexpr uint8_t network<6>::pairs[][2];
+constexpr uint8_t network<7>::pairs[][2];
+constexpr uint8_t network<8>::pairs[][2];
+constexpr uint8_t network<9>::pairs[][2];
+constexpr uint8_t network<10>::pairs[][2];
+constexpr uint8_t network<11>::pairs[][2];
+constexpr uint8_t network<12>::pairs[][2];
+constexpr uint8_t network<13>::pairs[][2];
+constexpr uint8_t network<14>::pairs[][2];
+constexpr uint8_t network<15>::pairs[][2];
+constexpr uint8_t network<16>::pairs[][2];
+}	// namespace detail
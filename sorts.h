@@ -1,144 +1,577 @@
-/*******************************************************************
-*   sorts.h
-*   Sorting Networks
-*
-*	Author: Kareem Omar
-*	kareem.omar@uah.edu
-*	https://github.com/komrad36
-*
-*	Last updated Feb 15, 2017
-*******************************************************************/
-//
-// SUMMARY: I present novel and state-of-the-art sorting of 4 int32_t
-// and sorting of 6 int8_t, as examples, using SSE4, and some thoughts
-// and notes on fast sorting of small fixed-size arrays.
-//
-// These are the fastest known approaches on modern CPUs.
-// They are completely branchless and extremely fast.
-// For example, 4 int32_t can be sorted in ~18 cycles on Skylake.
-//
-// These examples can be modified to sort signed or unsigned data as long
-// as the total size of the data is <= 128 bits (16 bytes). Note that
-// trying to use AVX2 to push that to 256 bits will NOT HELP
-// because of the 3 cycle interlane latency that makes shuffling
-// across the 128-bit lane boundary too expensive to be useful.
-//
-// In that case, or in the case that you can't support SSE4,
-// efficient scalar code can also be generated that isn't too much
-// slower, but it's not immediately evident what the optimal approach
-// is in assembly, nor how to coerce C/C++ compilers to produce that
-// assembly from C/C++ code. (I discuss the approach at the end of this
-// documentation.)
-//
-// Not all compilers correctly generate optimal assembly for either the
-// SSE or scalar code, so I provide assembly versions too. In fact, this
-// is not a strong enough statement; many compilers FAIL MISERABLY
-// at both the SSE and scalar cases for n >= 3. CL in particular
-// (Microsoft Visual C++) just dies horribly in a fire, so the assembly
-// snippets may not be a bad idea. Profile and/or check your disassembly.
-//
-// Note that these assembly snippets use the Windows x64 calling convention,
-// but then proceed to clobber a bunch of registers they shouldn't. Normally
-// they'd be inlined. Feel free to callee-save registers that your
-// application cannot safely clobber.
-//
-// These code snippets work on the principle of sorting networks.
-// Conventional sorting algorithms like quicksort and mergesort
-// are not great at small array sizes. One notices in profiling that
-// simpler sorts like insertion and selection tend to win. However,
-// even these are not NEARLY as fast as they could be for
-// fixed-size, small arrays.
-//
-// Available sorts and their function names:
-//
-// >>> SSE Assembly (fast as hell. FASTEST option on modern CPUs.
-//					 these are written in MASM for Win64;
-//					 but it's Intel syntax and you can make the small
-//					 modifications required for other assemblers.)
-// Sorting 4 int32_t  |  simdsort4a()
-// Sorting 4 int32_t  |  simdsort4a_noconstants()
-// Sorting 4 int32_t  |  simdsort4a_nofloat()
-//
-// >>> SSE C++ (make sure generated assembly matches):
-// Sorting 4 int32_t  |  simdsort4()
-// Sorting 6 int8_t   |  simdsort6()
-//
-// >>> Scalar Assembly (these are written in MASM for Win64;
-//						but it's Intel syntax and you can make the small
-//						modifications required for other assemblers.)
-// Sorting 2 int32_t  |  sort2a()
-// Sorting 3 int32_t  |  sort3a()
-// Sorting 4 int32_t  |  sort4a()
-// Sorting 5 int32_t  |  sort5a()
-// Sorting 6 int32_t  |  sort6a()
-//
-// >>> Scalar C++ (make sure generated assembly matches)
-// Sorting 2 int32_t  |  sort2()
-// Sorting 6 int32_t  |  sort6()
-//
-//
-// Okay, if you've made it this far, let's discuss
-// fast conditional swap operations.Conditional swaps
-// if the lower element is greater are the heart of sorting
-// networks.Given two values,
-// 'a', and 'b', leave them as they are if 'a' is less
-// than 'b', i.e. if they are in sorted order.However,
-// swap them if 'a' is greater than or equal to 'b'.
-// Thus after such a conditional swap operation 'a' and 'b' are in sorted
-// order no matter what order they came in as.
-//
-// A series of such operations can deterministically sort
-// a fixed - size array. Typically one can optimize for depth
-// (minimum number of operations given infinite parallel
-// processing) or for size (minimum number of operations given
-// no parallel processing). For n == 4 these two optimal solutions
-// are actually given by the same network, with depth 3 and
-// size 5.
-//
-// Scalar first : how do you efficiently conditional swap ? Again, note that
-// lots of compilers don't produce optimal assembly no matter
-// what C++ you give them.But what is the optimal assembly ?
-// Well, on modern processors, the answer is conditional moves :
-//
-// ; inputs: eax, r9d
-// ; scratch register: edx
-//	cmp     eax, r9d
-//	mov     edx, eax
-//	cmovg   eax, r9d
-//	cmovg   r9d, edx
-// ; eax and r9d have been swapped if necessary such that eax is now <= r9d
-//
-// See the function 'sort6' in 'sorts.cpp' for an attempt at some C++ code
-// that has a decent chance of compiling into conditional swaps that look like that.
-// Again, they OFTEN DON'T, especially the CL compiler and g++. Use the assembly
-// snippets instead, or at least profile and inspect your disassembly to be sure.
-//
-// The SSE sorts are rather more sophisticated, but the basic principle
-// is to branchlessly generate shuffle index masks at runtime and then
-// use them to permute the order of the data in parallel, performing
-// one complete level of the sorting network at a time.
-//
-// I provide 3 versions of the assembly for sorting 4 int32_t. The fastest
-// should be the plain 'simdsort4a'. It performs float reinterpretation
-// and relies on some constant loads, but both of these are USUALLY
-// better than the alternatives. However:
-//
-// Older CPUs may incur too much latency from the reinterpretation to be
-// worth it. For such CPUs, try 'simdsort4a_nofloat.asm'.
-//
-// Applications that cannot afford to have these constants occupying L1
-// may wish to try 'simdsort4a_noconstants.asm', which does not eat
-// up any cache space with constants - everything is done with immediates
-// and some fairly nasty bit twiddling.
-//
-
-#pragma once
-
-#include <cstdint>
-#include <immintrin.h>
-
-void sort2(int* __restrict v);
-void sort6(int* __restrict v);
-
-void simdsort4(int* __restrict v);
-void simdsort6(char* __restrict v);
+/*******************************************************************
+*   sorts.h
+*   Sorting Networks
+*
+*	Author: Kareem Omar
+*	kareem.omar@uah.edu
+*	https://github.com/komrad36
+*
+*	Last updated Feb 15, 2017
+*******************************************************************/
+//
+// SUMMARY: I present novel and state-of-the-art sorting of 4 int32_t
+// and sorting of 6 int8_t, as examples, using SSE4, and some thoughts
+// and notes on fast sorting of small fixed-size arrays.
+//
+// These are the fastest known approaches on modern CPUs.
+// They are completely branchless and extremely fast.
+// For example, 4 int32_t can be sorted in ~18 cycles on Skylake.
+//
+// These examples can be modified to sort signed or unsigned data as long
+// as the total size of the data is <= 128 bits (16 bytes). Note that
+// trying to use AVX2 to push that to 256 bits will NOT HELP
+// because of the 3 cycle interlane latency that makes shuffling
+// across the 128-bit lane boundary too expensive to be useful.
+//
+// In that case, or in the case that you can't support SSE4,
+// efficient scalar code can also be generated that isn't too much
+// slower, but it's not immediately evident what the optimal approach
+// is in assembly, nor how to coerce C/C++ compilers to produce that
+// assembly from C/C++ code. (I discuss the approach at the end of this
+// documentation.)
+//
+// Not all compilers correctly generate optimal assembly for either the
+// SSE or scalar code, so I provide assembly versions too. In fact, this
+// is not a strong enough statement; many compilers FAIL MISERABLY
+// at both the SSE and scalar cases for n >= 3. CL in particular
+// (Microsoft Visual C++) just dies horribly in a fire, so the assembly
+// snippets may not be a bad idea. Profile and/or check your disassembly.
+//
+// Note that these assembly snippets use the Windows x64 calling convention,
+// but then proceed to clobber a bunch of registers they shouldn't. Normally
+// they'd be inlined. Feel free to callee-save registers that your
+// application cannot safely clobber.
+//
+// These code snippets work on the principle of sorting networks.
+// Conventional sorting algorithms like quicksort and mergesort
+// are not great at small array sizes. One notices in profiling that
+// simpler sorts like insertion and selection tend to win. However,
+// even these are not NEARLY as fast as they could be for
+// fixed-size, small arrays.
+//
+// Available sorts and their function names:
+//
+// >>> SSE Assembly (fast as hell. FASTEST option on modern CPUs.
+//					 these are written in MASM for Win64;
+//					 but it's Intel syntax and you can make the small
+//					 modifications required for other assemblers.)
+// Sorting 4 int32_t  |  simdsort4a()
+// Sorting 4 int32_t  |  simdsort4a_noconstants()
+// Sorting 4 int32_t  |  simdsort4a_nofloat()
+//
+// >>> SSE C++ (make sure generated assembly matches):
+// Sorting 4 int32_t  |  simdsort4()
+// Sorting 4 int32_t, in-register  |  simdsort4_reg()
+// Sorting 4 int32_t  |  simdsort4_nofloat()
+// Sorting 4 int32_t, no constants  |  simdsort4_noconstants()
+// Sorting 6 int8_t   |  simdsort6()
+// Sorting 6 int8_t, no constants   |  simdsort6_noconstants()
+// Sorting 6 int8_t, stable   |  simdsort6_stable()
+// Sorting 6 int8_t, in-register   |  simdsort6_reg()
+// Merging sorted 4+4 int32_t, in-register  |  simdmerge4x2()
+// Sorting 8 int32_t   |  simdsort8()
+// Sorting 16 int32_t  |  simdsort16()
+// Sorting 8 int16_t   |  simdsort8_epi16()
+// Sorting 4 int16_t   |  simdsort4_epi16()
+// Sorting 2 int64_t   |  simdsort2_epi64()
+// Sorting 4 int64_t   |  simdsort4_epi64()
+// Sorting 2 double    |  simdsort2d()
+// Sorting 4 double    |  simdsort4d()
+// Sorting n <= 16 int32_t, runtime n  |  sort_small()
+// Sorting many 4 int32_t  |  simdsort4_batch()
+// Sorting many 4 int32_t, non-temporal  |  simdsort4_batch_stream()
+// Sorting many 4 int32_t, multithreaded  |  simdsort4_batch_parallel()
+// Sorting many 4 int32_t, column layout  |  simdsort4_soa()  (+ AoS<->SoA converters)
+// Sorting many 4 int32_t, indexed (gather)  |  simdsort4_gather()
+// Sorting many 6 int8_t   |  simdsort6_batch()
+// Median pair of 4 int32_t  |  median4()
+// Top two of 4 int32_t       |  max2of4()
+// Ranks (sort permutation) of 4 int32_t  |  rank4()
+// Sort + dedupe 4 int32_t  |  sort_unique4()
+// Sort + dedupe 6 int8_t   |  sort_unique6()
+// Sorting 4 uint32_t  |  simdsort4u()
+// Sorting 4 float     |  simdsort4f()
+// Sorting 6 uint8_t   |  simdsort6u()
+// Sorting 4 int32_t + payload  |  simdsort4kv()
+// Sorting 6 int8_t + payload   |  simdsort6kv()
+// Sorting N of int8/16/32, generated  |  netsort<N, T>()  (netsort.h)
+// Sliding median filter, window N  |  MedianFilter<N>  (medianfilter.h)
+//
+// >>> AVX2 C++ (vertical/column-wise; requires __AVX2__):
+// Sorting 8x 4 int32_t  |  simdsort4x8()
+//
+// >>> AVX-512 C++ (vertical/column-wise batch paths; selected at build
+//					time inside simdsort4_batch / simdsort6_batch)
+//
+// >>> Runtime dispatch (dispatch.cpp; CPUID-resolved once at startup)
+// Best kernel for this CPU  |  simdsort4_best / simdsort6_best /
+//                              simdsort4_batch_best / simdsort6_batch_best
+//
+// >>> Scalar Assembly (these are written in MASM for Win64;
+//						but it's Intel syntax and you can make the small
+//						modifications required for other assemblers.)
+// Sorting 2 int32_t  |  sort2a()
+// Sorting 3 int32_t  |  sort3a()
+// Sorting 4 int32_t  |  sort4a()
+// Sorting 5 int32_t  |  sort5a()
+// Sorting 6 int32_t  |  sort6a()
+// Sorting 8 int32_t  |  sort8a()
+// Sorting 16 int32_t |  sort16a()
+// Sorting 4 int64_t  |  sort4a64()
+// (System V / ELF ports of all the assembly kernels, for gas, are in
+//  sorts_sysv.S - same names, link it directly on Linux.)
+//
+// >>> Scalar C++ (make sure generated assembly matches)
+// Sorting 2 int32_t  |  sort2()
+// Sorting 6 int32_t  |  sort6()
+// Sorting 6 int32_t, stable  |  sort6_stable()
+// Sorting 6 int32_t + payload  |  sort6kv()
+// Sorting 4 int64_t  |  sort4_epi64()
+// Median of 5 int32_t  |  median5()
+// Sorting N (2-16) of any T  |  sortN<N, T>()
+//
+//
+// Okay, if you've made it this far, let's discuss
+// fast conditional swap operations.Conditional swaps
+// if the lower element is greater are the heart of sorting
+// networks.Given two values,
+// 'a', and 'b', leave them as they are if 'a' is less
+// than 'b', i.e. if they are in sorted order.However,
+// swap them if 'a' is greater than or equal to 'b'.
+// Thus after such a conditional swap operation 'a' and 'b' are in sorted
+// order no matter what order they came in as.
+//
+// A series of such operations can deterministically sort
+// a fixed - size array. Typically one can optimize for depth
+// (minimum number of operations given infinite parallel
+// processing) or for size (minimum number of operations given
+// no parallel processing). For n == 4 these two optimal solutions
+// are actually given by the same network, with depth 3 and
+// size 5.
+//
+// Scalar first : how do you efficiently conditional swap ? Again, note that
+// lots of compilers don't produce optimal assembly no matter
+// what C++ you give them.But what is the optimal assembly ?
+// Well, on modern processors, the answer is conditional moves :
+//
+// ; inputs: eax, r9d
+// ; scratch register: edx
+//	cmp     eax, r9d
+//	mov     edx, eax
+//	cmovg   eax, r9d
+//	cmovg   r9d, edx
+// ; eax and r9d have been swapped if necessary such that eax is now <= r9d
+//
+// See the function 'sort6' in 'sorts.cpp' for an attempt at some C++ code
+// that has a decent chance of compiling into conditional swaps that look like that.
+// Again, they OFTEN DON'T, especially the CL compiler and g++. Use the assembly
+// snippets instead, or at least profile and inspect your disassembly to be sure.
+//
+// The SSE sorts are rather more sophisticated, but the basic principle
+// is to branchlessly generate shuffle index masks at runtime and then
+// use them to permute the order of the data in parallel, performing
+// one complete level of the sorting network at a time.
+//
+// I provide 3 versions of the assembly for sorting 4 int32_t. The fastest
+// should be the plain 'simdsort4a'. It performs float reinterpretation
+// and relies on some constant loads, but both of these are USUALLY
+// better than the alternatives. However:
+//
+// Older CPUs may incur too much latency from the reinterpretation to be
+// worth it. For such CPUs, try 'simdsort4a_nofloat.asm'.
+//
+// Applications that cannot afford to have these constants occupying L1
+// may wish to try 'simdsort4a_noconstants.asm', which does not eat
+// up any cache space with constants - everything is done with immediates
+// and some fairly nasty bit twiddling.
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <immintrin.h>
+
+void sort2(int* __restrict v);
+void sort6(int* __restrict v);
+
+void simdsort4(int* __restrict v);
+void simdsort6(char* __restrict v);
+
+// register-to-register cores: for pipelines whose values already live
+// in xmm registers, these skip the load at entry and the store at
+// exit that the pointer versions pay (and the store-forward stall the
+// consumer can hit reloading them). The argument arrives in xmm0 and
+// the result leaves in xmm0; the pointer versions are thin wrappers.
+// simdsort6_reg sorts the low 6 bytes and passes the upper 10 through
+__m128i simdsort4_reg(__m128i a);
+__m128i simdsort6_reg(__m128i a);
+
+// merges two individually sorted registers of 4 int32_t into one
+// sorted run of 8 across (a, b): reverse b so the 8 form a bitonic
+// sequence, one vertical min/max level, then a fixed-shuffle bitonic
+// merge of 4 inside each register. 6 min/max + 5 shuffles + 2 blends,
+// no memory traffic. Composed with simdsort4_reg() this is the
+// building block for small SIMD mergesorts (simdsort8/simdsort16 are
+// built exactly this way)
+void simdmerge4x2(__m128i& a, __m128i& b);
+
+// the 'no float' variant: same network as simdsort4() but pshufb
+// instead of permutevar, so it needs only SSE4 (no AVX) and never
+// pays the int->float bypass latency. Worth trying on pre-Skylake
+// parts - see the discussion of simdsort4a_nofloat.asm above
+void simdsort4_nofloat(int* __restrict v);
+
+// the 'no constants' variants: every mask is an immediate baked into
+// the instruction stream, so the kernels own zero data-cache lines -
+// the C++ counterparts of simdsort4a_noconstants.asm. simdsort4
+// builds its blend masks from a 64-bit compare and pshufd broadcasts;
+// the 6-element version sign-extends to words and runs an odd-even
+// transposition network out of immediate shuffles, word min/max and
+// immediate blends, packing back at the end. Slower than the plain
+// kernels when the constants are L1-resident; faster at cold call
+// sites (e.g. between large scans) where every call would otherwise
+// open with constant-load misses.
+void simdsort4_noconstants(int* __restrict v);
+void simdsort6_noconstants(char* __restrict v);
+
+// stable variants: equal keys keep their original relative order,
+// for tie-breaking logic that depends on input order. The plain
+// networks don't guarantee this - a non-adjacent comparator can carry
+// an element past an equal one it never compares against. The scalar
+// version swaps the 3 extra comparators of an adjacent-only odd-even
+// transposition network for the guarantee (stability in a comparator
+// network is exactly 'adjacent exchanges only'); the SIMD version
+// instead tags each widened int16 lane with its index in the low
+// byte, simdsort6kv-style, so ties break by position inside the same
+// 128-bit register - no second code path, no extra register pressure
+void sort6_stable(int* __restrict v);
+void simdsort6_stable(char* __restrict v);
+
+// out-of-place overloads: same networks, sorted output written to a
+// separate buffer. Breaks the store-to-load dependency on the input
+// array when the consumer of the sorted data runs in the same
+// iteration, and lets the result flow straight into a destination
+// ring buffer instead of bouncing through the input.
+void sort6(const int* __restrict in, int* __restrict out);
+void simdsort4(const int* __restrict in, int* __restrict out);
+void simdsort6(const char* __restrict in, char* __restrict out);
+
+// pruned partial-sort kernels for callers that only need part of the
+// sorted output: the two middle elements of 4, the top two of 4, or
+// the median of 5. Dead comparators of the full networks are dropped,
+// which cuts latency on filter loops that discard the rest.
+void median4(const int* __restrict v, int* __restrict out);
+void max2of4(const int* __restrict v, int* __restrict out);
+int median5(const int* __restrict v);
+
+// element-type variants of the SIMD kernels. simdsort4u sorts uint32
+// by XORing the sign bit at load and store (one op each way) so the
+// signed compares in the passes see the right order; simdsort6u does
+// the same for uint8. simdsort4f sorts float by mapping bit patterns
+// through the monotonic float-to-int transform and sorting as int32;
+// this induces a total order, so NaNs never corrupt the permutation -
+// positive NaNs sort above +inf, negative NaNs below -inf, and -0.0f
+// sorts before 0.0f.
+void simdsort4u(uint32_t* __restrict v);
+void simdsort4f(float* __restrict v);
+void simdsort6u(uint8_t* __restrict v);
+
+// key-value variants: sort the keys and carry a payload of associated
+// values through the same permutation, so the caller gets the sort
+// permutation applied "for free" instead of recomputing it by search.
+// The SIMD versions reuse the shuffle masks the key sort already
+// computes, at the cost of one extra permute per pass; the scalar
+// sort6kv swaps key and payload off a single comparison per comparator.
+void simdsort4kv(int* __restrict k, int* __restrict p);
+void sort6kv(int* __restrict v, int* __restrict p);
+void simdsort6kv(char* __restrict v, char* __restrict p);
+
+// The sort permutation without the sort: rank of v[i] = number of
+// elements preceding it in sorted order, computed by accumulating
+// pairwise compare masks over three rotations of the register - no
+// shuffle-mask passes at all, cheaper than sorting when only the
+// permutation is live. Ties break by index, so the ranks are always
+// a permutation of {0,1,2,3}. rank4_reg returns them one per dword
+// lane; rank4 packs the rank of v[i] into bits [4i, 4i+4) of an int.
+__m128i rank4_reg(__m128i a);
+int rank4(const int* __restrict v);
+
+// fused sort + deduplicate: sorts in place, compacts the distinct
+// values to the front, and returns their count - all before the final
+// store, so it replaces a sort followed by a scalar duplicate scan at
+// barely more than the cost of the sort. Duplicate detection is one
+// compare against the element-shifted register; the movemask indexes
+// a table of compaction shuffles. Lanes past the returned count hold
+// copies of the largest distinct value.
+int sort_unique4(int* __restrict v);
+int sort_unique6(char* __restrict v);
+
+// n = 8 and n = 16 int32_t: each register of 4 is sorted with the
+// simdsort4 shuffle passes (several registers in flight at once), then
+// the sorted 4s are combined with bitonic merges built from vertical
+// _mm_min_epi32/_mm_max_epi32 levels. Scalar assembly fallbacks live
+// in sort8a.asm / sort16a.asm alongside sort5a.asm / sort6a.asm.
+void simdsort8(int* __restrict v);
+void simdsort16(int* __restrict v);
+
+// 16-bit elements: 8 int16_t fill one xmm register, so the optimal
+// 19-comparator, depth-6 network for n = 8 runs entirely in-register
+// with the simdsort6 shuffle-mask technique at epi16 compare width -
+// no widening to int32, no merge step. simdsort4_epi16 is the same
+// idea on the 3-level n = 4 network, touching only 8 bytes of memory.
+void simdsort8_epi16(int16_t* __restrict v);
+void simdsort4_epi16(int16_t* __restrict v);
+
+// 64-bit keys (timestamps, hashes, doubles). No 64-bit integer
+// min/max exists below AVX-512, so the SIMD conditional swap is
+// _mm_cmpgt_epi64 (SSE4.2) feeding _mm_blendv_epi8. A register holds
+// only 2 elements: n = 2 is one in-register swap, n = 4 runs the
+// 5-comparator network across two registers. The double versions map
+// bit patterns through the 64-bit widening of simdsort4f's monotonic
+// transform and sort as int64 (same NaN policy: total order, output
+// always a permutation). sort4_epi64 is the scalar cmov tier, with
+// assembly in sort4a64.asm / sorts_sysv.S as sort4a64().
+void simdsort2_epi64(int64_t* __restrict v);
+void simdsort4_epi64(int64_t* __restrict v);
+void simdsort2d(double* __restrict v);
+void simdsort4d(double* __restrict v);
+void sort4_epi64(int64_t* __restrict v);
+
+#ifdef __AVX2__
+// sorts 8 back-to-back arrays of 4 int32_t each (32 contiguous elements)
+// in one shot. Note this does NOT contradict the discussion above about
+// AVX2 being useless for a single array: the trick is to transpose so
+// that one ymm register holds element position 0 of all 8 arrays, the
+// next holds position 1, etc. Then the whole 5-comparator network is
+// just vertical _mm256_min_epi32/_mm256_max_epi32 pairs - no shuffles
+// at all - and the transpose itself needs only in-lane unpacks.
+void simdsort4x8(int* __restrict v);
+#endif
+
+// sorts 'count' back-to-back arrays of 4 int32_t each, i.e. 4*count
+// contiguous elements of which each group of 4 is sorted independently.
+// Keeps two arrays in flight so the _mm_permutevar_ps of one array
+// overlaps the _mm_cmpgt_epi32 of the next instead of stalling on
+// the 3-pass dependency chain. Roughly doubles throughput over
+// calling simdsort4() in a loop. When compiled with AVX-512F the
+// implementation switches to a vertical 16-arrays-per-pass kernel
+// with masked tail handling instead.
+void simdsort4_batch(int* __restrict v, size_t count);
+
+// streaming flavor of simdsort4_batch for batches far beyond LLC:
+// prefetches ahead on the load side and writes results with
+// non-temporal (write-combining) stores, so the batch neither pays
+// read-for-ownership on the store side nor evicts the working set of
+// whatever runs next. sfence on exit. 'v' should be 16-byte aligned
+// (misaligned input silently falls back to the cached version). Use
+// the cached version when the sorted records are consumed right away
+void simdsort4_batch_stream(int* __restrict v, size_t count);
+
+// multithreaded batch driver (parallel.cpp, needs <thread>): splits
+// the batch into chunks of whole 64-byte lines (4 records each, so no
+// false sharing between workers) and lets 'threads' workers claim
+// chunks dynamically off a shared atomic counter - dynamic rather
+// than static partitioning, so uneven page-fault cost or a preempted
+// core doesn't strand part of the job. threads == 0 means
+// hardware_concurrency(); small batches run inline on the caller
+void simdsort4_batch_parallel(int* __restrict v, size_t count, size_t threads);
+
+// structure-of-arrays batch: record i is (col0[i], col1[i], col2[i],
+// col3[i]). The vertical batch formulation with the transposes
+// deleted - every comparator is one min + one max at full register
+// width and there are no shuffles at all, so if the producer can emit
+// columns directly this beats the AoS path by the whole cost of the
+// two transposes. The converters do bulk AoS <-> SoA via 4x4 unpack
+// transposes for callers stuck with row-major data at one end.
+void simdsort4_soa(int* __restrict col0, int* __restrict col1, int* __restrict col2, int* __restrict col3, size_t count);
+void simdsort4_aos_to_soa(const int* __restrict v, int* __restrict col0, int* __restrict col1, int* __restrict col2, int* __restrict col3, size_t count);
+void simdsort4_soa_to_aos(const int* __restrict col0, const int* __restrict col1, const int* __restrict col2, const int* __restrict col3, int* __restrict v, size_t count);
+
+// gather/sort/scatter for non-contiguous records: group g is the four
+// ints base[indices[4g]] .. base[indices[4g+3]], sorted into the
+// contiguous out[4g..4g+3]. The scattered loads dominate, so the loop
+// software-prefetches the data pointers several groups ahead and
+// keeps two groups in flight so gathers overlap sort passes; with
+// AVX2 each gather is a single vpgatherdd. 'out' must not alias the
+// gathered sources.
+void simdsort4_gather(const int* __restrict base, const int* __restrict indices, size_t count, int* __restrict out);
+
+// sorts 'count' back-to-back arrays of 6 int8_t each. Plain loop over
+// simdsort6() unless compiled with AVX-512VBMI+BW, in which case 16
+// arrays go through the network per pass: VPERMB transposes the
+// stride-6 bytes into columns, the 12 comparators run as vertical
+// byte min/max, and mask registers cover any tail.
+void simdsort6_batch(char* __restrict v, size_t count);
+
+// runtime CPU dispatch (dispatch.cpp): these pointers are bound
+// exactly once, during static initialization, by a CPUID/XGETBV probe
+// that picks the best kernel this CPU can actually run - so one
+// binary can ship to a whole fleet without per-call branches and
+// without faulting with SIGILL on the oldest hosts. simdsort4_best
+// prefers the permutevar version where AVX is present and the core is
+// Skylake or newer, the pshufb 'no float' version on older AVX parts
+// (bypass latency - see the notes above), and a scalar network if
+// even SSE4 is missing. The batch pointers additionally verify that
+// whatever ISA this translation unit was *compiled* for (AVX-512
+// paths etc.) is really present, falling back to the single-array
+// kernels if not. Call through them like plain functions:
+//
+//     simdsort4_best(v);
+//     simdsort4_batch_best(v, count);
+//
+extern void (*const simdsort4_best)(int* __restrict v);
+extern void (*const simdsort6_best)(char* __restrict v);
+extern void (*const simdsort4_batch_best)(int* __restrict v, size_t count);
+extern void (*const simdsort6_batch_best)(char* __restrict v, size_t count);
+
+// runtime-n entry point for n <= 16: one indirect call through a jump
+// table indexed by n, so mixed-size call sites pay no branch
+// misprediction cascade. Sizes without a dedicated kernel are padded
+// to the next kernel size with INT32_MAX sentinels in a local buffer
+// and still take the branchless SIMD path. n > 16 is not supported
+void sort_small(int* __restrict v, size_t n);
+
+// generic front-end: sortN<N, T>(v) sorts N contiguous elements of any
+// type with operator<, dispatching at compile time to the best known
+// comparator network for that N - handcrafted optimal networks up to
+// N == 11, Batcher odd-even merge for 12 through 16. The comparator
+// lists are constexpr with constexpr bounds, so the pass loop fully
+// unrolls and each comparator compiles to the same branchless
+// min/max (cmov) idiom as sort6(). As always, profile and check your
+// disassembly - see the sermon on compilers at the top of this file.
+namespace detail {
+
+template <size_t N> struct network;
+template <> struct network<2> {
+	static constexpr uint8_t pairs[][2] = { { 0, 1 } };
+};
+template <> struct network<3> {
+	static constexpr uint8_t pairs[][2] = { { 1, 2 }, { 0, 2 }, { 0, 1 } };
+};
+template <> struct network<4> {
+	static constexpr uint8_t pairs[][2] = { { 0, 1 }, { 2, 3 }, { 0, 2 }, { 1, 3 }, { 1, 2 } };
+};
+template <> struct network<5> {
+	static constexpr uint8_t pairs[][2] = {
+		{ 0, 1 }, { 3, 4 }, { 2, 4 }, { 2, 3 }, { 1, 4 }, { 0, 3 }, { 0, 2 }, { 1, 3 },
+		{ 1, 2 }
+	};
+};
+template <> struct network<6> {
+	// same network and order as sort6()
+	static constexpr uint8_t pairs[][2] = {
+		{ 1, 2 }, { 0, 2 }, { 0, 1 }, { 4, 5 }, { 3, 5 }, { 3, 4 }, { 0, 3 }, { 1, 4 },
+		{ 2, 5 }, { 2, 4 }, { 1, 3 }, { 2, 3 }
+	};
+};
+template <> struct network<7> {
+	static constexpr uint8_t pairs[][2] = {
+		{ 1, 2 }, { 3, 4 }, { 5, 6 }, { 0, 2 }, { 3, 5 }, { 4, 6 }, { 0, 1 }, { 4, 5 },
+		{ 2, 6 }, { 0, 4 }, { 1, 5 }, { 0, 3 }, { 2, 5 }, { 1, 3 }, { 2, 4 }, { 2, 3 }
+	};
+};
+template <> struct network<8> {
+	static constexpr uint8_t pairs[][2] = {
+		{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 },
+		{ 1, 2 }, { 5, 6 }, { 0, 4 }, { 3, 7 }, { 1, 5 }, { 2, 6 }, { 1, 4 }, { 3, 6 },
+		{ 2, 4 }, { 3, 5 }, { 3, 4 }
+	};
+};
+template <> struct network<9> {
+	static constexpr uint8_t pairs[][2] = {
+		{ 0, 1 }, { 3, 4 }, { 6, 7 }, { 1, 2 }, { 4, 5 }, { 7, 8 }, { 0, 1 }, { 3, 4 },
+		{ 6, 7 }, { 0, 3 }, { 3, 6 }, { 0, 3 }, { 1, 4 }, { 4, 7 }, { 1, 4 }, { 2, 5 },
+		{ 5, 8 }, { 2, 5 }, { 1, 3 }, { 5, 7 }, { 2, 6 }, { 4, 6 }, { 2, 4 }, { 2, 3 },
+		{ 5, 6 }
+	};
+};
+template <> struct network<10> {
+	static constexpr uint8_t pairs[][2] = {
+		{ 4, 9 }, { 3, 8 }, { 2, 7 }, { 1, 6 }, { 0, 5 }, { 1, 4 }, { 6, 9 }, { 0, 3 },
+		{ 5, 8 }, { 0, 2 }, { 3, 6 }, { 7, 9 }, { 0, 1 }, { 2, 4 }, { 5, 7 }, { 8, 9 },
+		{ 1, 2 }, { 4, 6 }, { 7, 8 }, { 3, 5 }, { 2, 5 }, { 6, 8 }, { 1, 3 }, { 4, 7 },
+		{ 2, 3 }, { 6, 7 }, { 3, 4 }, { 5, 6 }, { 4, 5 }
+	};
+};
+template <> struct network<11> {
+	static constexpr uint8_t pairs[][2] = {
+		{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, { 8, 9 }, { 1, 3 }, { 5, 7 }, { 0, 2 },
+		{ 4, 6 }, { 8, 10 }, { 1, 2 }, { 5, 6 }, { 9, 10 }, { 0, 4 }, { 3, 7 }, { 1, 5 },
+		{ 6, 10 }, { 4, 8 }, { 5, 9 }, { 2, 6 }, { 0, 4 }, { 3, 8 }, { 1, 5 }, { 6, 10 },
+		{ 2, 3 }, { 8, 9 }, { 1, 4 }, { 7, 10 }, { 3, 5 }, { 6, 8 }, { 2, 4 }, { 7, 9 },
+		{ 5, 6 }, { 3, 4 }, { 7, 8 }
+	};
+};
+template <> struct network<12> {
+	static constexpr uint8_t pairs[][2] = {
+		{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, { 8, 9 }, { 10, 11 }, { 0, 2 }, { 1, 3 },
+		{ 4, 6 }, { 5, 7 }, { 8, 10 }, { 9, 11 }, { 1, 2 }, { 5, 6 }, { 9, 10 }, { 0, 4 },
+		{ 1, 5 }, { 2, 6 }, { 3, 7 }, { 2, 4 }, { 3, 5 }, { 1, 2 }, { 3, 4 }, { 5, 6 },
+		{ 9, 10 }, { 0, 8 }, { 1, 9 }, { 2, 10 }, { 3, 11 }, { 4, 8 }, { 5, 9 },
+		{ 6, 10 }, { 7, 11 }, { 2, 4 }, { 3, 5 }, { 6, 8 }, { 7, 9 }, { 1, 2 }, { 3, 4 },
+		{ 5, 6 }, { 7, 8 }, { 9, 10 }
+	};
+};
+template <> struct network<13> {
+	static constexpr uint8_t pairs[][2] = {
+		{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, { 8, 9 }, { 10, 11 }, { 0, 2 }, { 1, 3 },
+		{ 4, 6 }, { 5, 7 }, { 8, 10 }, { 9, 11 }, { 1, 2 }, { 5, 6 }, { 9, 10 }, { 0, 4 },
+		{ 1, 5 }, { 2, 6 }, { 3, 7 }, { 8, 12 }, { 2, 4 }, { 3, 5 }, { 10, 12 }, { 1, 2 },
+		{ 3, 4 }, { 5, 6 }, { 9, 10 }, { 11, 12 }, { 0, 8 }, { 1, 9 }, { 2, 10 },
+		{ 3, 11 }, { 4, 12 }, { 4, 8 }, { 5, 9 }, { 6, 10 }, { 7, 11 }, { 2, 4 },
+		{ 3, 5 }, { 6, 8 }, { 7, 9 }, { 10, 12 }, { 1, 2 }, { 3, 4 }, { 5, 6 }, { 7, 8 },
+		{ 9, 10 }, { 11, 12 }
+	};
+};
+template <> struct network<14> {
+	static constexpr uint8_t pairs[][2] = {
+		{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, { 8, 9 }, { 10, 11 }, { 12, 13 },
+		{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 }, { 8, 10 }, { 9, 11 }, { 1, 2 }, { 5, 6 },
+		{ 9, 10 }, { 0, 4 }, { 1, 5 }, { 2, 6 }, { 3, 7 }, { 8, 12 }, { 9, 13 }, { 2, 4 },
+		{ 3, 5 }, { 10, 12 }, { 11, 13 }, { 1, 2 }, { 3, 4 }, { 5, 6 }, { 9, 10 },
+		{ 11, 12 }, { 0, 8 }, { 1, 9 }, { 2, 10 }, { 3, 11 }, { 4, 12 }, { 5, 13 },
+		{ 4, 8 }, { 5, 9 }, { 6, 10 }, { 7, 11 }, { 2, 4 }, { 3, 5 }, { 6, 8 }, { 7, 9 },
+		{ 10, 12 }, { 11, 13 }, { 1, 2 }, { 3, 4 }, { 5, 6 }, { 7, 8 }, { 9, 10 },
+		{ 11, 12 }
+	};
+};
+template <> struct network<15> {
+	static constexpr uint8_t pairs[][2] = {
+		{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, { 8, 9 }, { 10, 11 }, { 12, 13 },
+		{ 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 }, { 8, 10 }, { 9, 11 }, { 12, 14 },
+		{ 1, 2 }, { 5, 6 }, { 9, 10 }, { 13, 14 }, { 0, 4 }, { 1, 5 }, { 2, 6 },
+		{ 3, 7 }, { 8, 12 }, { 9, 13 }, { 10, 14 }, { 2, 4 }, { 3, 5 }, { 10, 12 },
+		{ 11, 13 }, { 1, 2 }, { 3, 4 }, { 5, 6 }, { 9, 10 }, { 11, 12 }, { 13, 14 },
+		{ 0, 8 }, { 1, 9 }, { 2, 10 }, { 3, 11 }, { 4, 12 }, { 5, 13 }, { 6, 14 },
+		{ 4, 8 }, { 5, 9 }, { 6, 10 }, { 7, 11 }, { 2, 4 }, { 3, 5 }, { 6, 8 }, { 7, 9 },
+		{ 10, 12 }, { 11, 13 }, { 1, 2 }, { 3, 4 }, { 5, 6 }, { 7, 8 }, { 9, 10 },
+		{ 11, 12 }, { 13, 14 }
+	};
+};
+template <> struct network<16> {
+	static constexpr uint8_t pairs[][2] = {
+		{ 0, 1 }, { 2, 3 }, { 4, 5 }, { 6, 7 }, { 8, 9 }, { 10, 11 }, { 12, 13 },
+		{ 14, 15 }, { 0, 2 }, { 1, 3 }, { 4, 6 }, { 5, 7 }, { 8, 10 }, { 9, 11 },
+		{ 12, 14 }, { 13, 15 }, { 1, 2 }, { 5, 6 }, { 9, 10 }, { 13, 14 }, { 0, 4 },
+		{ 1, 5 }, { 2, 6 }, { 3, 7 }, { 8, 12 }, { 9, 13 }, { 10, 14 }, { 11, 15 },
+		{ 2, 4 }, { 3, 5 }, { 10, 12 }, { 11, 13 }, { 1, 2 }, { 3, 4 }, { 5, 6 },
+		{ 9, 10 }, { 11, 12 }, { 13, 14 }, { 0, 8 }, { 1, 9 }, { 2, 10 }, { 3, 11 },
+		{ 4, 12 }, { 5, 13 }, { 6, 14 }, { 7, 15 }, { 4, 8 }, { 5, 9 }, { 6, 10 },
+		{ 7, 11 }, { 2, 4 }, { 3, 5 }, { 6, 8 }, { 7, 9 }, { 10, 12 }, { 11, 13 },
+		{ 1, 2 }, { 3, 4 }, { 5, 6 }, { 7, 8 }, { 9, 10 }, { 11, 12 }, { 13, 14 }
+	};
+};
+
+}	// namespace detail
+
+template <size_t N, typename T>
+void sortN(T* __restrict v) {
+	static_assert(N >= 2 && N <= 16, "sortN: no network defined for this N");
+	for (const auto& p : detail::network<N>::pairs) {
+		const T a = v[p[1]] < v[p[0]] ? v[p[1]] : v[p[0]];
+		const T b = v[p[1]] < v[p[0]] ? v[p[0]] : v[p[1]];
+		v[p[0]] = a;
+		v[p[1]] = b;
+	}
+}